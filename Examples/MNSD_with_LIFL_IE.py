@@ -14,6 +14,7 @@ import nest
 import nest.raster_plot
 import numpy as np
 import matplotlib.pyplot as plt
+import lifl_ie_io
 if not 'lifl_psc_exp_ie' in nest.Models():
     nest.Install('LIFL_IEmodule')
 
@@ -61,14 +62,33 @@ nest.Connect(D3,D2, {"rule": "one_to_one"}, { "model": "stdp_synapse", 'delay':
 nest.Connect(D3,D4, {"rule": "one_to_one"}, { "model": "stdp_synapse", 'delay': 0.1});
 nest.Connect(D4,D3, {"rule": "one_to_one"}, { "model": "stdp_synapse", 'delay': 0.1});
         
-# We create a Detector so that we can get spike times and raster plot
-detector = nest.Create('spike_detector'); 
+# We create a Detector so that we can get spike times and raster plot; it writes the spikes to
+# compact files (MNSD_spikes-<vp>.spks), from which each trial is read alone
+detector = nest.Create('compact_spike_recorder', params = {'filename': 'MNSD_spikes'}); 
 nest.Connect(D1,detector); nest.Connect(D2, detector); nest.Connect(D3, detector); nest.Connect(D4, detector); nest.Connect(Target, detector);
 nest.Connect(N1, detector); nest.Connect(N2, detector); nest.Connect(N3, detector); nest.Connect(N4, detector);
+# The latency recorder keeps the first spike and the number of spikes of each detector in each 1000 ms trial
+latency = nest.Create('latency_recorder', params = {'trial_period': 1000.0})
+nest.Connect(D1 + D2 + D3 + D4, latency)
 # We create a multim to record the Voltage potential of the membrane (V_m)
-# and the excitability parameter of Intrinsic Plasticity (soma_exc)
-multim = nest.Create('multimeter', params = {'withtime': True, 'record_from': ['V_m', 'soma_exc'], 'interval': 0.1})
+multim = nest.Create('multimeter', params = {'withtime': True, 'record_from': ['V_m'], 'interval': 0.1})
 nest.Connect(multim, Target); nest.Connect(multim, D1); nest.Connect(multim, D2); nest.Connect(multim, D3); nest.Connect(multim, D4) #Target
+# Only the first 100 ms of each 1000 ms trial, around the stimulus, are recorded
+nest.SetStatus(D1 + D2 + D3 + D4 + Target, {'record_windows': [0.0, 100.0], 'record_period': 1000.0})
+# The excitability parameter of Intrinsic Plasticity (soma_exc) only changes when a modulator spike
+# arrives, so only these changes are recorded
+ie_rec = nest.Create('ie_recorder')
+nest.sli_func('ConnectIERecorder', ie_rec[0], list(D1 + D2 + D3 + D4))
+
+def ie_trajectory(gid, at):
+    """ soma_exc of neuron gid at the times at, from the recorded changes """
+    ie_events = nest.GetStatus(ie_rec)[0]['events']
+    mask = ie_events['senders'] == gid
+    value = ie_events['soma_exc'][mask]
+    if len(value) == 0:
+        return np.asarray(nest.GetStatus([gid], 'soma_exc') * len(at))
+    initial = value[0] - ie_events['delta'][mask][0]
+    return np.concatenate(([initial], value))[np.searchsorted(ie_events['times'][mask], at, side='right')]
 
 # We create a matrix to save the spike times of each trial
 iterations = 300
@@ -83,24 +103,29 @@ for i in range(1,iterations): #450
     nest.SetStatus(D1, {"V_m": -70.0}); nest.SetStatus(D2, {"V_m": -70.0}); nest.SetStatus(D3, {"V_m": -70.0}); nest.SetStatus(D4, {"V_m": -70.0}); nest.SetStatus(Target, {"V_m": -70.0})
     
     nest.Simulate(1000) # Simulate 1000 ms per trial
-    
-    # We get the status of the detector in order to get the spike times and save them
-    spikes = nest.GetStatus(detector)[0]['events']
-    t_spikes = spikes['times'][spikes['times']>(1000*i)-1000]; sends_spikes = spikes['senders'][len(spikes['senders'])-len(t_spikes):];
-    times1 = t_spikes[sends_spikes == 9]; times2 = t_spikes[sends_spikes == 10]; times3 = t_spikes[sends_spikes == 11]; times4 = t_spikes[sends_spikes == 12]
-    if len(times1)==1: times[i,0] = times1-(1000*i)+1000; times[i,4] = times[i,4]+1
-    if len(times2)==1: times[i,1] = times2-(1000*i)+1000; times[i,4] = times[i,4]+1
-    if len(times3)==1: times[i,2] = times3-(1000*i)+1000; times[i,4] = times[i,4]+1
-    if len(times4) == 1: times[i, 3] = times4 - (1000 * i) + 1000; times[i, 4] = times[i, 4] + 1
+
+# The spikes at the end of the last trial are delivered one min_delay later
+nest.Simulate(nest.GetKernelStatus('min_delay'))
+
+# We save the spike times of the detectors (D1-D4) that fired exactly once in a trial, relative to the
+# trial onset (0 otherwise), and the number of such detectors
+detection = nest.GetStatus(latency)[0]
+latencies = detection['latencies'].reshape(-1, len(detection['neurons']))
+single = detection['n_spikes'].reshape(latencies.shape) == 1
+times[1:len(latencies)+1, 0:4] = np.where(single, latencies, 0.0)
+times[1:len(latencies)+1, 4] += single.sum(axis=1)
+print('Mean latency differences D_i - D_j over the trials in which both fired [ms]:')
+print(detection['delta_mean'].reshape(4, 4))
 
 # Raster plot
-nest.raster_plot.from_device(detector)
+nest.raster_plot.from_data(np.column_stack(lifl_ie_io.read_spike_streams('MNSD_spikes')))
 
-# We get events of multimeter (V_m and Soma_exc)
+# We get events of multimeter (V_m) and of the IE recorder (soma_exc)
 events = nest.GetStatus(multim)[0]['events']
-t = np.linspace(int(min(events['times'])), int(max(events['times']))+1, (int(max(events['times']))+1)*10-1);
+t = events['times'][events['senders']==9] # the same recording windows for all neurons
 v_1 = events['V_m'][events['senders']==9];v_2 = events['V_m'][events['senders']==10];v_3 = events['V_m'][events['senders']==11];v_4 = events['V_m'][events['senders']==12]; v_5 = events['V_m'][events['senders']==13];
-se1 = events['soma_exc'][events['senders']==9]-1;se2 = events['soma_exc'][events['senders']==10]-1;se3 = events['soma_exc'][events['senders']==11]-1; se4 = events['soma_exc'][events['senders']==12]-1;
+trial_ends = np.arange(1, iterations) * 1000.0 # IE at the end of each trial
+se1 = ie_trajectory(9, trial_ends)-1;se2 = ie_trajectory(10, trial_ends)-1;se3 = ie_trajectory(11, trial_ends)-1; se4 = ie_trajectory(12, trial_ends)-1;
 plt.figure(); plt.plot(t, v_1); plt.plot(t, v_2); plt.plot(t, v_3); plt.plot(t, v_4); plt.plot(t, v_5); plt.ylabel('Membrane potential [mV]')
 
 from mpl_toolkits.mplot3d import Axes3D
@@ -138,7 +163,7 @@ plt.plot(se1)
 plt.plot(se2)
 plt.plot(se3)
 plt.plot(se4)
-plt.xticks([0, 1000000, 2000000, 3000000], [0, 100, 200, 300]); plt.xlabel('Training trials'); plt.ylabel('Intrinsic Excitability (IE)')
+plt.xticks([0, 100, 200, 300], [0, 100, 200, 300]); plt.xlabel('Training trials'); plt.ylabel('Intrinsic Excitability (IE)')
 
 plt.figure();    #  PLOT DELAY deltas
 plt.plot(delta1)
@@ -195,11 +220,10 @@ nest.Simulate(1000)
 
 
 
-# We get events of multimeter (V_m and Soma_exc)
+# We get events of multimeter (V_m)
 events = nest.GetStatus(multim)[0]['events']
-t = np.linspace(int(min(events['times'])), int(max(events['times']))+1, (int(max(events['times']))+1)*10-1);
+t = events['times'][events['senders']==9] # the same recording windows for all neurons
 v_1 = events['V_m'][events['senders']==9];v_2 = events['V_m'][events['senders']==10];v_3 = events['V_m'][events['senders']==11];v_4 = events['V_m'][events['senders']==12]; v_5 = events['V_m'][events['senders']==13];
-se1 = events['soma_exc'][events['senders']==9]-1;se2 = events['soma_exc'][events['senders']==10]-1;se3 = events['soma_exc'][events['senders']==11]-1; se4 = events['soma_exc'][events['senders']==12]-1;
 plt.figure(); plt.plot(t, v_1); plt.plot(t, v_2); plt.plot(t, v_3); plt.plot(t, v_4); plt.plot(t, v_5); plt.ylabel('Membrane potential [mV]')
 
 plt.figure()
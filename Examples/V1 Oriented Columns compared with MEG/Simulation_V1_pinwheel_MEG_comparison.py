@@ -13,7 +13,11 @@ import nest.raster_plot
 import numpy as np
 import scipy.io
 import pickle
+import os
+import sys
 
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from lifl_ie_io import convert_response_pickle # Spike files for the spike_file_player
 
 if not 'lifl_psc_exp_ie' in nest.Models(): # Load our customized NEST Simulator module for MNSD.
     nest.Install('LIFL_IEmodule')
@@ -36,13 +40,20 @@ nest.SetKernelStatus({'resolution': 0.1})  # Time resolution set at 0.1 ms
 plt.close('all')
 
 GCells = 324  # Number of Ganglionar Cells (Same number for #Retina = #LGN = #SS4 )
-spikingGanglion = range(0, 324, 1)
-inputs = nest.Create("spike_generator", GCells)
-InputsDetector = nest.Create('spike_detector')
-nest.Connect(inputs, InputsDetector)
-
 LGN = nest.Create('parrot_neuron', GCells) # Parrot neurons will fire at same time than Ganglionar Cells (retina)
-nest.Connect(inputs, LGN, 'one_to_one')
+InputsDetector = nest.Create('spike_detector')
+nest.Connect(LGN, InputsDetector)
+
+# The Ganglionar Cells (retina) are played from a spike file, channel j drives LGN[j].
+# With generate_stimulus, the Gabor response is generated during the simulation instead
+# (orientation 90º, randn noise 0.2), which allows to sweep stimuli and noise seeds.
+generate_stimulus = False
+if generate_stimulus:
+    inputs = nest.Create('gabor_lgn_generator', 1, {'targets': list(LGN), 'rows': 18, 'columns': 18,
+                                                    'orientation': 90.0, 'noise': 0.2, 'seed': 19})
+else:
+    inputs = nest.Create('spike_file_player', 1, {'targets': list(LGN)})
+nest.Connect(inputs, LGN, 'all_to_all')
 
 # We create the V1 columns defined on the function
 Detector0, Spikes0, Multimeter0, SomaMultimeter0, Pyr230, SS40, Pyr50, Pyr60, In230, In40, In50, In60 = column(0, LGN)
@@ -50,36 +61,59 @@ Detector45, Spikes45, Multimeter45, SomaMultimeter45, Pyr2345, SS445, Pyr545, Py
 Detector90, Spikes90, Multimeter90, SomaMultimeter90, Pyr2390, SS490, Pyr590, Pyr690, In2390, In490, In590, In690 = column(90, LGN)
 Detector135, Spikes135, Multimeter135, SomaMultimeter135, Pyr23135, SS4135, Pyr5135, Pyr6135, In23135, In4135, In5135, In6135 = column(135, LGN)
 
+# LFP proxy of each column: the excitatory synaptic currents of the pyramidal cells, weighted
+# by dendrite length, are summed during the simulation and only the sum is stored.
+# (81 cells of each layer averaged over 96, as in the original analysis)
+# The sum over the pinwheel is also compared with the MEG recording while it is simulated.
+LFP = {}
+LFP_sum = nest.Create('lfp_aggregator', 1, {'interval': 0.1, 'to_memory': False})
+for d, layers in ((0, (Pyr230, Pyr50, Pyr60)), (45, (Pyr2345, Pyr545, Pyr645)),
+                  (90, (Pyr2390, Pyr590, Pyr690)), (135, (Pyr23135, Pyr5135, Pyr6135))):
+    LFP[d] = nest.Create('lfp_aggregator', 1, {'interval': 0.1})
+    for cells, dendrite in zip(layers, (0.000482, 0.001342, 0.000963)):
+        for aggregator in (LFP[d], LFP_sum):
+            nest.sli_func('ConnectAggregator', aggregator[0], list(cells[:80] + cells[-1:]), dendrite / 96, 0.0)
+
+# Online fit against the 500 ms of MEG (600 Hz) that the analysis below uses; the reference
+# starts 300 ms before the stimulus, i.e. 500 ms before the end of the simulation.
+from scipy.io import loadmat
+warmup = float(400 + np.round(np.random.rand(1)*200)) # about half a second to initialize the network and assure randomness on results
+Comparator = nest.Create('meg_comparator', 1, {'source': LFP_sum[0], 'reference': list(loadmat("./files/MEGGaborStimScoutTSeries.mat")['Value'][0, 420:720]),
+                                               'reference_interval': 1000.0 / 600, 'max_lag': 50.0, 'origin': warmup - 300.0})
+
 
 print(simulations) # In this file wil be only 1
-nest.Simulate(400 + np.round(np.random.rand(1)*200)) # We simulate about half a second to initialize the network and assure randomness on results
+nest.Simulate(warmup)
 
 
 # file 19 corresponds with angle 90º ;   We give some randomness to spike times. (Avoiding spikes to be exactly in same time step)
-exec('file = "./files/spikes_reponse_gabor_randn02_19.pckl"')
-with open(file, 'rb') as f:
-    u = pickle._Unpickler(f)
-    u.encoding = 'latin1'
-    resultados = u.load()
-    senders = resultados['senders'];
-    times = resultados['times']
-
 currtime = nest.GetKernelStatus('time')
-for j in range(0, len(spikingGanglion)):
-    spike_time = times[senders == min(senders)+j] + currtime
-    nest.SetStatus([inputs[j]], {'spike_times': spike_time})
-
+if generate_stimulus:
+    nest.SetStatus(inputs, {'origin': currtime, 'stop': 200.0})
+else:
+    # The response is converted once to a spike file, which the player streams from disk
+    file = "./files/spikes_reponse_gabor_randn02_19.spk"
+    if not os.path.exists(file):
+        convert_response_pickle("./files/spikes_reponse_gabor_randn02_19.pckl", GCells, file)
+    nest.SetStatus(inputs, {'filename': file, 'origin': currtime})
+
+# The spikes of the warm-up are not needed for the OSI
+nest.SetStatus(Spikes0 + Spikes45 + Spikes90 + Spikes135, {'n_events': 0})
 nest.Simulate(200)
 
+fit = nest.GetStatus(Comparator)[0]
+print('Online comparison with MEG: r = %.3f, RMSE = %.3g, best lag %.1f ms (r = %.3f)'
+      % (fit['correlation'], fit['rmse'], fit['best_lag'], fit['best_correlation']))
+
 
 ###  Orientation Selectivity Index (OSI)
 # Now we Calculate the OSI index by extracting the firing rate from layer 2/3 in both 0º an 90ª
-senders = nest.GetStatus(Spikes0)[0]['events']['senders'][nest.GetStatus(Spikes0)[0]['events']['times'] > currtime]
-times = nest.GetStatus(Spikes0)[0]['events']['times'][nest.GetStatus(Spikes0)[0]['events']['times'] > currtime]
-rate230 = len(times[np.isin(senders, Pyr230)])
-senders = nest.GetStatus(Spikes90)[0]['events']['senders'][nest.GetStatus(Spikes90)[0]['events']['times'] > currtime]
-times = nest.GetStatus(Spikes90)[0]['events']['times'][nest.GetStatus(Spikes90)[0]['events']['times'] > currtime]
-rate2390 = len(times[np.isin(senders, Pyr2390)])
+spikes = nest.sli_func('FetchSpikes', Spikes0[0])
+senders = spikes['senders'][spikes['times'] > currtime]
+rate230 = np.count_nonzero(np.isin(senders, Pyr230))
+spikes = nest.sli_func('FetchSpikes', Spikes90[0])
+senders = spikes['senders'][spikes['times'] > currtime]
+rate2390 = np.count_nonzero(np.isin(senders, Pyr2390))
 OSI[simulations, 0] = (rate2390 - rate230) / (rate2390 + rate230)
 
 #  ####### PREFERRED COLUMN:  V_m membrane potential
@@ -163,24 +197,13 @@ del v_1, v_2, v_3, v_4, v_5, v_6, v_7
 t = np.linspace(0,498, 4999)
 LFP_pinwheel = np.zeros([1,4999]); plt.figure(); s = 1
 for d in [0, 45, 90, 135]:
-    exec('eventsSyn = nest.GetStatus(Multimeter' + str(d) + ')[0]["events"];')
-    exec('Pyr23 = Pyr23' + str(d) + '; Pyr5 = Pyr5' + str(d) + '; Pyr6 = Pyr6' + str(d) + ';')
-    syn_23 = np.zeros([96,5000-1]); syn_5 = np.zeros([96,5000-1]); syn_6 = np.zeros([96,5000-1]); k = 0-1
-    for j in range(0, 324, 36):
-        for i in range(0, 18, 2):
-            syn_23tmp = eventsSyn['I_syn_ex'][eventsSyn['senders'] == Pyr23[k]]
-            syn_23[k,:] = syn_23tmp[len(syn_23tmp)-4999:]* 0.000482
-            syn_5tmp = eventsSyn['I_syn_ex'][eventsSyn['senders'] == Pyr5[k]]
-            syn_5[k,:] = syn_5tmp[len(syn_5tmp)-4999:]  * 0.001342
-            syn_6tmp = eventsSyn['I_syn_ex'][eventsSyn['senders'] == Pyr6[k]]
-            syn_6[k,:] = syn_6tmp[len(syn_6tmp)-4999:]  * 0.000963
-            k += 1
-    exec('syn_exc_' + str(d) + ' = (np.mean(syn_23, axis=0) + np.mean(syn_5, axis=0) + np.mean(syn_6, axis=0))')
+    signal = nest.GetStatus(LFP[d])[0]['events']['signal']
+    exec('syn_exc_' + str(d) + ' = signal[len(signal)-4999:]')
     plt.subplot(4,1,s)
     eval('plt.plot(t, syn_exc_' + str(d) + ', "k")')
     plt.gca().spines['left'].set_color('none'); plt.xticks([]); plt.gca().spines['top'].set_color('none'); plt.xticks([]); plt.gca().spines['bottom'].set_color('none');plt.gca().yaxis.tick_right(); plt.ylabel(str(d) + "º")
     exec('LFP_pinwheel = LFP_pinwheel + syn_exc_' + str(d))
-    del syn_23, syn_23tmp, syn_5, syn_5tmp, syn_6, syn_6tmp
+    del signal
     s += 1
 SynLFP[simulations, :] = syn_exc_0 + syn_exc_45 + syn_exc_90 + syn_exc_135
 
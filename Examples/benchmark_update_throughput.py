@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+     ----- Update throughput of the LIFL_IE neuron models -----
+Microbenchmark of the per-step update of lifl_psc_exp_ie and
+aeif_psc_exp_peak. A population of unconnected neurons is driven by
+Poisson input, so that the update loop, the ring buffers and the spike
+handling are exercised, but no network connectivity.
+
+Run it with builds of the module before and after a change of the node
+layout to compare the update throughput, e.g.
+
+    python3 benchmark_update_throughput.py --model lifl_psc_exp_ie -n 20000
+
+Reported is the number of neuron updates (neurons x steps) per second of
+wall-clock time, as the best of several repetitions.
+"""
+
+import argparse
+import time
+
+import nest
+
+parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+parser.add_argument('--model', default='lifl_psc_exp_ie',
+                    choices=['lifl_psc_exp_ie', 'aeif_psc_exp_peak'])
+parser.add_argument('-n', '--neurons', type=int, default=10000)
+parser.add_argument('-t', '--time', type=float, default=1000.0,
+                    help='simulated time per repetition in ms')
+parser.add_argument('-r', '--repetitions', type=int, default=5)
+parser.add_argument('--threads', type=int, default=1)
+parser.add_argument('--resolution', type=float, default=0.1)
+args = parser.parse_args()
+
+if args.model not in nest.Models():
+    nest.Install('LIFL_IEmodule')
+
+nest.ResetKernel()
+nest.SetKernelStatus({'resolution': args.resolution,
+                      'local_num_threads': args.threads,
+                      'print_time': False})
+
+neurons = nest.Create(args.model, args.neurons)
+noise = nest.Create('poisson_generator', 1, {'rate': 2000.0})
+nest.Connect(noise, neurons, 'all_to_all', {'weight': 50.0})
+
+# Warm-up: first calibration and buffer allocation are not measured
+nest.Simulate(args.time)
+
+best = float('inf')
+for rep in range(args.repetitions):
+    start = time.time()
+    nest.Simulate(args.time)
+    best = min(best, time.time() - start)
+
+steps = args.time / args.resolution
+updates = args.neurons * steps / best
+print('%s: %d neurons, %d threads, %.0f steps in %.3f s -> %.3e updates/s'
+      % (args.model, args.neurons, args.threads, steps, best, updates))
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+     ----- Checkpoint round trip -----
+Restores a full checkpoint followed by an incremental one into a freshly
+built network and checks that the IE plasticity continues exactly as in an
+uninterrupted run.
+
+The modulator stays silent between the two checkpoints, so the plasticity
+state of the detector does not change in that interval. Its time stamps
+must nevertheless come out of the incremental checkpoint, otherwise they
+would be restored relative to the time of the full one.
+"""
+
+import os
+import tempfile
+
+import nest
+
+T_FULL = 200.0  # ms, time of the full checkpoint
+T_INCR = 500.0  # ms, time of the incremental checkpoint
+T_END = 800.0   # ms
+DETECTOR_SPIKES = [50.0, 150.0, 610.0]
+MODULATOR_SPIKES = [650.0]
+
+
+def build(offset):
+    """Build the network, with all input given relative to offset."""
+    nest.ResetKernel()
+    if not 'lifl_psc_exp_ie' in nest.Models():
+        nest.Install('LIFL_IEmodule')
+    nest.SetKernelStatus({'resolution': 0.1})
+
+    detector = nest.Create('lifl_psc_exp_ie', 1,
+                           {'lambda': 0.01, 'tau': 500.0})
+    modulator = nest.Create('lifl_psc_exp_ie', 1)
+    nest.SetStatus(detector, {'stimulator': [modulator[0]]})
+
+    drive_d = nest.Create('spike_generator', 1, {'spike_times': [
+        t - offset for t in DETECTOR_SPIKES if t > offset]})
+    drive_m = nest.Create('spike_generator', 1, {'spike_times': [
+        t - offset for t in MODULATOR_SPIKES if t > offset]})
+    nest.Connect(drive_d, detector, syn_spec={'weight': 3700.0})
+    nest.Connect(drive_m, modulator, syn_spec={'weight': 3700.0})
+    nest.Connect(modulator, detector, syn_spec={'weight': 1.0})
+
+    spikes = nest.Create('spike_detector')
+    nest.Connect(detector, spikes)
+    return detector, spikes
+
+
+def result(detector, spikes, offset):
+    times = nest.GetStatus(spikes, 'events')[0]['times'] + offset
+    return nest.GetStatus(detector, 'soma_exc')[0], sorted(times)
+
+
+# uninterrupted run
+detector, spikes = build(0.0)
+nest.Simulate(T_END)
+reference = result(detector, spikes, 0.0)
+
+# full and incremental checkpoint of the same run
+tmp = tempfile.mkdtemp()
+full = os.path.join(tmp, 'full.ckpt')
+incr = os.path.join(tmp, 'incr.ckpt')
+
+detector, spikes = build(0.0)
+nest.Simulate(T_FULL)
+nest.sli_func('SaveCheckpoint', full, [], False)
+nest.Simulate(T_INCR - T_FULL)
+nest.sli_func('SaveCheckpoint', incr, [], True)
+before = result(detector, spikes, 0.0)
+
+# restore both into a fresh network at time 0 and run the remainder
+detector, spikes = build(T_INCR)
+nest.sli_func('RestoreCheckpoint', full)
+nest.sli_func('RestoreCheckpoint', incr)
+nest.Simulate(T_END - T_INCR)
+after = result(detector, spikes, T_INCR)
+
+restored = (after[0], before[1] + after[1])
+print('enhancement  uninterrupted: %.12f  restored: %.12f'
+      % (reference[0], restored[0]))
+assert reference[0] != 1.0, 'IE plasticity was not triggered'
+assert abs(reference[0] - restored[0]) < 1e-12
+assert reference[1] == restored[1]
+print('checkpoint round trip passed')
@@ -0,0 +1,351 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+     ----- File formats of the LIFL_IE module -----
+Readers and writers for the binary files used by the devices of the
+LIFL_IE module.
+
+Spike files (spike_file_player): the spike trains of a number of input
+channels, stored as one stream of spikes sorted by time, see the
+documentation of spike_file. An existing response file of the V1 example
+is converted with
+
+    python3 lifl_ie_io.py spikes_reponse_gabor_randn02_19.pckl 324
+
+which writes spikes_reponse_gabor_randn02_19.spk next to it.
+
+Analog files (binary_multimeter): recordables of a number of neurons in
+chunks of columns, see the documentation of analog_file. read_analog_file
+maps the columns of each chunk, analog_file_data joins the chunks.
+
+Spike streams (compact_spike_recorder): spikes as varint-encoded blocks
+with a block index, see the documentation of spike_stream.
+read_spike_stream decodes the blocks of a time window of one file,
+read_spike_streams those of all files of a recorder.
+
+Shared memory rings (shm_recorder): the latest records of a recorder, see
+the documentation of shm_ring. ShmRingReader maps a ring while the
+simulation runs and returns the records written since its last read.
+"""
+
+import glob
+import mmap
+import pickle
+import sys
+
+import numpy as np
+
+SPIKE_FILE_MAGIC = b'LIFLSPKF'
+SPIKE_FILE_VERSION = 1
+
+spike_file_header = np.dtype([('magic', 'S8'), ('version', '=u4'),
+                              ('n_channels', '=u4'), ('n_spikes', '=u8')])
+spike_file_record = np.dtype([('time', '=f8'), ('channel', '=u4'),
+                              ('reserved', '=u4')])
+
+
+def write_spike_file(filename, channels, times, n_channels=None):
+    """
+    Write spikes given as arrays of channels and times (in ms, relative to
+    the origin of the player) to a spike file. The spikes need not be
+    sorted. n_channels defaults to the highest channel + 1.
+    """
+    channels = np.asarray(channels, dtype=np.int64)
+    times = np.asarray(times, dtype=np.float64)
+    if channels.shape != times.shape:
+        raise ValueError('channels and times must have the same length')
+    if len(channels) and channels.min() < 0:
+        raise ValueError('channels must not be negative')
+    if n_channels is None:
+        n_channels = int(channels.max()) + 1 if len(channels) else 0
+    elif len(channels) and channels.max() >= n_channels:
+        raise ValueError('channel out of range')
+
+    order = np.argsort(times, kind='stable')
+    records = np.zeros(len(times), dtype=spike_file_record)
+    records['time'] = times[order]
+    records['channel'] = channels[order]
+
+    header = np.zeros(1, dtype=spike_file_header)
+    header['magic'] = SPIKE_FILE_MAGIC
+    header['version'] = SPIKE_FILE_VERSION
+    header['n_channels'] = n_channels
+    header['n_spikes'] = len(records)
+
+    with open(filename, 'wb') as f:
+        header.tofile(f)
+        records.tofile(f)
+
+
+def read_spike_file(filename):
+    """
+    Read a spike file, return (n_channels, channels, times). The records are
+    mapped, not loaded, so that long files can be inspected in parts.
+    """
+    header = np.fromfile(filename, dtype=spike_file_header, count=1)
+    if (len(header) != 1 or header['magic'][0] != SPIKE_FILE_MAGIC
+            or header['version'][0] != SPIKE_FILE_VERSION):
+        raise ValueError(filename + ' is not a spike file')
+    records = np.memmap(filename, dtype=spike_file_record, mode='r',
+                        offset=spike_file_header.itemsize,
+                        shape=(int(header['n_spikes'][0]),))
+    return int(header['n_channels'][0]), records['channel'], records['time']
+
+ANALOG_FILE_MAGIC = b'LIFLANLG'
+ANALOG_FILE_VERSION = 1
+
+analog_file_header = np.dtype([('magic', 'S8'), ('version', '=u4'),
+                               ('n_recordables', '=u4'),
+                               ('n_neurons', '=u8'), ('interval', '=f8')])
+
+
+def read_analog_file(filename):
+    """
+    Read an analog file, return (gids, record_from, chunks), where chunks is
+    a list of (times, data) and data[i, j] holds recordable record_from[j]
+    of neuron gids[i] at the times. The data are mapped, not loaded. A
+    chunk cut short, e.g. by a simulation that was killed, is left out.
+    """
+    raw = np.memmap(filename, dtype=np.uint8, mode='r')
+    pos = analog_file_header.itemsize
+    if len(raw) < pos:
+        raise ValueError(filename + ' is not an analog file')
+    header = raw[:pos].view(analog_file_header)
+    if (header['magic'][0] != ANALOG_FILE_MAGIC
+            or header['version'][0] != ANALOG_FILE_VERSION):
+        raise ValueError(filename + ' is not an analog file')
+    n_rec = int(header['n_recordables'][0])
+    n_neurons = int(header['n_neurons'][0])
+
+    names = raw[pos:pos + 32 * n_rec].view('S32')
+    record_from = [n.decode() for n in names]
+    pos += 32 * n_rec
+    gids = raw[pos:pos + 8 * n_neurons].view('=u8')
+    pos += 8 * n_neurons
+
+    chunks = []
+    while pos + 8 <= len(raw):
+        n = int(raw[pos:pos + 8].view('=u8')[0])
+        end = pos + 8 + 8 * n * (1 + n_neurons * n_rec)
+        if end > len(raw):
+            break
+        columns = raw[pos + 8:end].view('=f8')
+        data = columns[n:].reshape(n_neurons, n_rec, n)
+        chunks.append((columns[:n], data))
+        pos = end
+    return gids, record_from, chunks
+
+
+def analog_file_data(filename):
+    """
+    Read an analog file into memory, return (gids, record_from, times,
+    data) with the chunks joined along the last axis of data.
+    """
+    gids, record_from, chunks = read_analog_file(filename)
+    if not chunks:
+        return (gids, record_from, np.zeros(0),
+                np.zeros((len(gids), len(record_from), 0)))
+    times = np.concatenate([t for t, _ in chunks])
+    data = np.concatenate([d for _, d in chunks], axis=2)
+    return gids, record_from, times, data
+
+SPIKE_STREAM_MAGIC = b'LIFLSPKS'
+SPIKE_STREAM_INDEX_MAGIC = b'LIFLSIDX'
+SPIKE_STREAM_VERSION = 1
+
+spike_stream_header = np.dtype([('magic', 'S8'), ('version', '=u4'),
+                                ('reserved', '=u4'), ('resolution', '=f8')])
+spike_stream_block = np.dtype([('first_step', '=i8'), ('last_step', '=i8'),
+                               ('n_spikes', '=u4'), ('n_bytes', '=u4')])
+spike_stream_index_entry = np.dtype([('first_step', '=i8'),
+                                     ('last_step', '=i8'),
+                                     ('offset', '=u8')])
+
+
+def decode_varints(data):
+    """ Decode an array of bytes holding unsigned LEB128 varints. """
+    data = np.asarray(data, dtype=np.uint8)
+    ends = np.flatnonzero(data < 0x80)
+    if len(ends) == 0:
+        return np.zeros(0, dtype=np.uint64)
+    starts = np.concatenate(([0], ends[:-1] + 1))
+    value_of = np.repeat(np.arange(len(ends)), ends - starts + 1)
+    shift = (7 * (np.arange(ends[-1] + 1) - starts[value_of])).astype(
+        np.uint64)
+    parts = (data[:ends[-1] + 1] & 0x7f).astype(np.uint64) << shift
+    return np.bitwise_or.reduceat(parts, starts)
+
+
+def read_spike_stream_index(filename):
+    """
+    Read the header and the block index of a spike stream, return
+    (resolution, raw, index), where raw maps the file and index holds the
+    first and last step and the offset of each block. The blocks of a file
+    without an index are found by walking the block headers.
+    """
+    raw = np.memmap(filename, dtype=np.uint8, mode='r')
+    pos = spike_stream_header.itemsize
+    if len(raw) < pos:
+        raise ValueError(filename + ' is not a spike stream')
+    header = raw[:pos].view(spike_stream_header)
+    if (header['magic'][0] != SPIKE_STREAM_MAGIC
+            or header['version'][0] != SPIKE_STREAM_VERSION):
+        raise ValueError(filename + ' is not a spike stream')
+    resolution = float(header['resolution'][0])
+
+    if len(raw) >= pos + 16 and raw[-8:].tobytes() == SPIKE_STREAM_INDEX_MAGIC:
+        n_blocks = int(raw[-16:-8].view('=u8')[0])
+        begin = len(raw) - 16 - n_blocks * spike_stream_index_entry.itemsize
+        if begin >= pos:
+            index = raw[begin:-16].view(spike_stream_index_entry)
+            return resolution, raw, index
+
+    entries = []
+    while pos + spike_stream_block.itemsize <= len(raw):
+        block = raw[pos:pos + spike_stream_block.itemsize].view(
+            spike_stream_block)[0]
+        end = pos + spike_stream_block.itemsize + int(block['n_bytes'])
+        if end > len(raw):
+            break  # cut short
+        entries.append((block['first_step'], block['last_step'], pos))
+        pos = end
+    return resolution, raw, np.array(entries, dtype=spike_stream_index_entry)
+
+
+def read_spike_stream(filename, t_start=None, t_stop=None):
+    """
+    Read the spikes of a spike stream with t_start < time <= t_stop, the
+    interval simulated by Simulate(t_stop - t_start) from t_start, and
+    return (senders, times) sorted by time. Only the blocks overlapping
+    the interval are decoded.
+    """
+    resolution, raw, index = read_spike_stream_index(filename)
+    first = (-np.inf if t_start is None
+             else np.rint(t_start / resolution))
+    last = np.inf if t_stop is None else np.rint(t_stop / resolution)
+    blocks = index[(index['last_step'] > first)
+                   & (index['first_step'] <= last)]
+    if not blocks.size:
+        return np.zeros(0, dtype=np.int64), np.zeros(0)
+
+    senders = []
+    steps = []
+    for first_step, _, offset in blocks:
+        begin = int(offset) + spike_stream_block.itemsize
+        block = raw[int(offset):begin].view(spike_stream_block)[0]
+        values = decode_varints(raw[begin:begin + int(block['n_bytes'])])
+        senders.append(values[0::2].astype(np.int64))
+        steps.append(first_step + np.cumsum(values[1::2].astype(np.int64)))
+
+    senders = np.concatenate(senders)
+    steps = np.concatenate(steps)
+    keep = (steps > first) & (steps <= last)
+    return senders[keep], steps[keep] * resolution
+
+
+def read_spike_streams(basename, t_start=None, t_stop=None):
+    """
+    Read the spikes of all files <basename>-<vp>.spks of a
+    compact_spike_recorder as read_spike_stream does, return
+    (senders, times) sorted by time.
+    """
+    parts = [read_spike_stream(f, t_start, t_stop)
+             for f in sorted(glob.glob(glob.escape(basename) + '-*.spks'))]
+    if not parts:
+        raise IOError('no spike streams ' + basename + '-*.spks')
+    senders = np.concatenate([p[0] for p in parts])
+    times = np.concatenate([p[1] for p in parts])
+    order = np.argsort(times, kind='stable')
+    return senders[order], times[order]
+
+SHM_RING_MAGIC = b'LIFLSHMR'
+SHM_RING_VERSION = 1
+
+shm_ring_header = np.dtype([('magic', 'S8'), ('version', '=u4'),
+                            ('n_values', '=u4'), ('record_size', '=u8'),
+                            ('capacity', '=u8'), ('data_offset', '=u8'),
+                            ('n_written', '=u8'), ('owner', '=i4'),
+                            ('reserved', 'V12')])
+
+
+class ShmRingReader(object):
+    """
+    Reader of the ring /<shm_name>-<vp> of a shm_recorder. records maps
+    all slots of the ring without copying, read() returns the records
+    written since the previous read. The ring exists from the first
+    Simulate of the recorder on.
+    """
+
+    def __init__(self, shm_name, vp=0):
+        with open('/dev/shm/%s-%d' % (shm_name, vp), 'rb') as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        header = np.frombuffer(self._map, dtype=shm_ring_header, count=1)[0]
+        if (header['magic'] != SHM_RING_MAGIC
+                or header['version'] != SHM_RING_VERSION):
+            raise ValueError(shm_name + ' is not a shm_recorder ring')
+        n_values = int(header['n_values'])
+
+        names = np.frombuffer(self._map, dtype='S32', count=n_values,
+                              offset=shm_ring_header.itemsize)
+        self.record_from = [n.decode() for n in names]
+        self.dtype = np.dtype([('time', '=f8'), ('sender', '=i8'),
+                               ('values', '=f8', (n_values,))])
+        self.capacity = int(header['capacity'])
+        self.records = np.frombuffer(self._map, dtype=self.dtype,
+                                     count=self.capacity,
+                                     offset=int(header['data_offset']))
+        self._n_written = np.frombuffer(
+            self._map, dtype='=u8', count=1,
+            offset=shm_ring_header.fields['n_written'][1])
+        self.position = 0  # records read
+        self.lost = 0      # records overwritten before they were read
+
+    def n_written(self):
+        """ Number of records the recorder has written. """
+        return int(self._n_written[0])
+
+    def read(self):
+        """
+        Return a copy of the records written since the previous read, in
+        the order they were written. Records the recorder has overwritten
+        before they were copied are skipped and counted in lost.
+        """
+        end = self.n_written()
+        begin = max(self.position, end - self.capacity)
+        out = self.records[np.arange(begin, end) % self.capacity]
+        # the recorder may have gone on writing during the copy; the slot
+        # of record k is being overwritten once capacity + k are written
+        valid = min(end, max(begin, self.n_written() - self.capacity + 1))
+        out = out[valid - begin:]
+        self.lost += valid - self.position
+        self.position = end
+        return out
+
+    def close(self):
+        self.records = self._n_written = None
+        self._map.close()
+
+
+def convert_response_pickle(filename, n_channels, out=None):
+    """
+    Convert a spikes_reponse_*.pckl file of the V1 example (events of a
+    spike_detector; the lowest sender is channel 0) to a spike file.
+    """
+    with open(filename, 'rb') as f:
+        u = pickle._Unpickler(f)
+        u.encoding = 'latin1'
+        events = u.load()
+    senders = np.asarray(events['senders'])
+    channels = senders - senders.min()
+    keep = channels < n_channels
+    if out is None:
+        out = filename.rsplit('.', 1)[0] + '.spk'
+    write_spike_file(out, channels[keep], np.asarray(events['times'])[keep],
+                     n_channels)
+    return out
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    print(convert_response_pickle(sys.argv[1], int(sys.argv[2])))
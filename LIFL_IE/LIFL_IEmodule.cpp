@@ -26,8 +26,24 @@
 #include "config.h"
 
 // include headers with your own stuff
+#include "checkpoint.h"
+#include "column_builder.h"
+#include "parallel_conditions.h"
+#include "stimulator_grid.h"
 #include "lifl_psc_exp_ie.h"
+#include "lifl_psc_exp_variant.h"
 #include "aeif_psc_exp_peak.h"
+#include "binary_multimeter.h"
+#include "compact_spike_recorder.h"
+#include "cursor_spike_recorder.h"
+#include "gabor_lgn_generator.h"
+#include "ie_recorder.h"
+#include "latency_recorder.h"
+#include "lfp_aggregator.h"
+#include "meg_comparator.h"
+#include "shm_recorder.h"
+#include "spike_file_player.h"
+#include "trial_dc_generator.h"
 
 // Includes from nestkernel:
 #include "connection_manager_impl.h"
@@ -40,12 +56,14 @@
 #include "model.h"
 #include "model_manager_impl.h"
 #include "nestmodule.h"
+#include "node_manager.h"
 #include "target_identifier.h"
 
 // Includes from sli:
 #include "booldatum.h"
 #include "integerdatum.h"
 #include "sliexceptions.h"
+#include "stringdatum.h"
 #include "tokenarray.h"
 
 // -- Interface to dynamic module loader ---------------------------------------
@@ -104,6 +122,336 @@ mynest::LIFL_IEmodule::commandstring( void ) const
 
 //-------------------------------------------------------------------------------------
 
+/* ----------------------------------------------------------------
+ * Helpers for module functions
+ * ---------------------------------------------------------------- */
+
+namespace
+{
+/**
+ * Return the instance of a node on the thread that updates it, or 0 if
+ * the node does not exist or is not local to this process.
+ */
+nest::Node*
+get_local_node( const nest::index gid )
+{
+  if ( gid == 0 or gid >= nest::kernel().node_manager.size() )
+  {
+    throw nest::UnknownNode( gid );
+  }
+  if ( not nest::kernel().node_manager.is_local_gid( gid ) )
+  {
+    return 0;
+  }
+  const nest::thread tid = nest::kernel().vp_manager.vp_to_thread(
+    nest::kernel().vp_manager.suggest_vp_for_gid( gid ) );
+  return nest::kernel().node_manager.get_node( gid, tid );
+}
+
+/**
+ * Collect the GIDs given on the stack, or all nodes if the array is empty.
+ */
+std::vector< nest::index >
+get_gids( const TokenArray& gids )
+{
+  std::vector< nest::index > result;
+  if ( gids.size() == 0 )
+  {
+    for ( nest::index gid = 1; gid < nest::kernel().node_manager.size(); ++gid )
+    {
+      result.push_back( gid );
+    }
+  }
+  else
+  {
+    result.reserve( gids.size() );
+    for ( size_t k = 0; k < gids.size(); ++k )
+    {
+      result.push_back( getValue< long >( gids[ k ] ) );
+    }
+  }
+  return result;
+}
+}
+
+/* ----------------------------------------------------------------
+ * Checkpoint functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::LIFL_IEmodule::SaveCheckpoint_s_a_bFunction::execute(
+  SLIInterpreter* i ) const
+{
+  // Check if we have (at least) three arguments on the stack.
+  i->assert_stack_load( 3 );
+
+  const std::string filename = getValue< std::string >( i->OStack.pick( 2 ) );
+  const TokenArray gid_array = getValue< TokenArray >( i->OStack.pick( 1 ) );
+  const bool incremental = getValue< bool >( i->OStack.pick( 0 ) );
+
+  const std::vector< nest::index > gids = get_gids( gid_array );
+
+  CheckpointWriter writer( filename, incremental );
+  for ( size_t k = 0; k < gids.size(); ++k )
+  {
+    Checkpointable* node =
+      dynamic_cast< Checkpointable* >( get_local_node( gids[ k ] ) );
+    if ( node != 0 )
+    {
+      node->save_checkpoint( writer );
+    }
+  }
+  writer.close();
+
+  i->OStack.pop( 3 );
+  i->OStack.push( static_cast< long >( writer.num_records() ) );
+  i->EStack.pop();
+}
+
+void
+mynest::LIFL_IEmodule::RestoreCheckpoint_sFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 1 );
+
+  const std::string filename = getValue< std::string >( i->OStack.pick( 0 ) );
+
+  CheckpointReader reader( filename );
+  long n_restored = 0;
+  while ( reader.next_node() )
+  {
+    nest::Node* node = get_local_node( reader.gid() );
+    if ( node == 0 )
+    {
+      continue; // record of a node on another MPI process
+    }
+
+    Checkpointable* target = dynamic_cast< Checkpointable* >( node );
+    if ( target == 0 )
+    {
+      throw CheckpointError( "Node " + std::to_string( reader.gid() )
+        + " does not support checkpointing." );
+    }
+    target->restore_checkpoint( reader );
+    ++n_restored;
+  }
+
+  i->OStack.pop( 1 );
+  i->OStack.push( n_restored );
+  i->EStack.pop();
+}
+
+/* ----------------------------------------------------------------
+ * Forked conditions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::LIFL_IEmodule::ForkConditions_i_i_iFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 3 );
+
+  const long detector = getValue< long >( i->OStack.pick( 2 ) );
+  const long n_conditions = getValue< long >( i->OStack.pick( 1 ) );
+  const long max_workers = getValue< long >( i->OStack.pick( 0 ) );
+
+  ConditionWorkers workers( detector, n_conditions, max_workers );
+  const long condition = workers.run();
+
+  i->OStack.pop( 3 );
+  if ( condition >= 0 )
+  {
+    i->OStack.push( condition ); // in the worker
+  }
+  else
+  {
+    i->OStack.push( workers.results() );
+  }
+  i->EStack.pop();
+}
+
+void
+mynest::LIFL_IEmodule::FinishCondition_bFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 1 );
+
+  const bool failed = getValue< bool >( i->OStack.pick( 0 ) );
+  ConditionWorkers::finish_worker( failed );
+
+  i->OStack.pop( 1 );
+  i->EStack.pop();
+}
+
+/* ----------------------------------------------------------------
+ * Network construction
+ * ---------------------------------------------------------------- */
+
+void
+mynest::LIFL_IEmodule::ConnectStimulatorGrid_a_DFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 2 );
+
+  const TokenArray gid_array = getValue< TokenArray >( i->OStack.pick( 1 ) );
+  const DictionaryDatum spec = getValue< DictionaryDatum >( i->OStack.pick( 0 ) );
+
+  std::vector< nest::index > gids;
+  gids.reserve( gid_array.size() );
+  for ( size_t k = 0; k < gid_array.size(); ++k )
+  {
+    gids.push_back( getValue< long >( gid_array[ k ] ) );
+  }
+
+  StimulatorGrid grid( gids, spec );
+  const long n_modulators = grid.connect();
+
+  i->OStack.pop( 2 );
+  i->OStack.push( n_modulators );
+  i->EStack.pop();
+}
+
+void
+mynest::LIFL_IEmodule::BuildColumn_DFunction::execute( SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 1 );
+
+  const DictionaryDatum spec = getValue< DictionaryDatum >( i->OStack.pick( 0 ) );
+
+  ColumnBuilder builder( spec );
+  const DictionaryDatum populations = builder.build();
+
+  i->OStack.pop( 1 );
+  i->OStack.push( populations );
+  i->EStack.pop();
+}
+
+/* ----------------------------------------------------------------
+ * Recording
+ * ---------------------------------------------------------------- */
+
+void
+mynest::LIFL_IEmodule::ConnectAggregator_i_a_d_dFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 4 );
+
+  const long aggregator_gid = getValue< long >( i->OStack.pick( 3 ) );
+  const TokenArray gid_array = getValue< TokenArray >( i->OStack.pick( 2 ) );
+  const double weight_ex = getValue< double >( i->OStack.pick( 1 ) );
+  const double weight_in = getValue< double >( i->OStack.pick( 0 ) );
+
+  long n_connected = 0;
+  for ( size_t k = 0; k < gid_array.size(); ++k )
+  {
+    nest::Node* node = get_local_node( getValue< long >( gid_array[ k ] ) );
+    if ( node == 0 )
+    {
+      continue; // neuron on another MPI process
+    }
+
+    AggregatorSource* source = dynamic_cast< AggregatorSource* >( node );
+    if ( source == 0 )
+    {
+      throw nest::IllegalConnection( "ConnectAggregator: "
+        + node->get_name() + " cannot be connected to an lfp_aggregator." );
+    }
+
+    // the neuron adds to the instance of the aggregator on its thread
+    lfp_aggregator* aggregator = dynamic_cast< lfp_aggregator* >(
+      nest::kernel().node_manager.get_node(
+        aggregator_gid, node->get_thread() ) );
+    if ( aggregator == 0 )
+    {
+      throw nest::IllegalConnection(
+        "ConnectAggregator: target is not an lfp_aggregator." );
+    }
+
+    source->connect_aggregator( *aggregator, weight_ex, weight_in );
+    ++n_connected;
+  }
+
+  i->OStack.pop( 4 );
+  i->OStack.push( n_connected );
+  i->EStack.pop();
+}
+
+void
+mynest::LIFL_IEmodule::ConnectIERecorder_i_aFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 2 );
+
+  const long recorder_gid = getValue< long >( i->OStack.pick( 1 ) );
+  const TokenArray gid_array = getValue< TokenArray >( i->OStack.pick( 0 ) );
+
+  long n_connected = 0;
+  for ( size_t k = 0; k < gid_array.size(); ++k )
+  {
+    nest::Node* node = get_local_node( getValue< long >( gid_array[ k ] ) );
+    if ( node == 0 )
+    {
+      continue; // neuron on another MPI process
+    }
+
+    lifl_psc_exp_ie* neuron = dynamic_cast< lifl_psc_exp_ie* >( node );
+    if ( neuron == 0 )
+    {
+      throw nest::IllegalConnection( "ConnectIERecorder: "
+        + node->get_name() + " has no intrinsic excitability." );
+    }
+
+    // the neuron records to the instance of the recorder on its thread
+    ie_recorder* recorder =
+      dynamic_cast< ie_recorder* >( nest::kernel().node_manager.get_node(
+        recorder_gid, node->get_thread() ) );
+    if ( recorder == 0 )
+    {
+      throw nest::IllegalConnection(
+        "ConnectIERecorder: target is not an ie_recorder." );
+    }
+
+    neuron->connect_ie_recorder( *recorder );
+    ++n_connected;
+  }
+
+  i->OStack.pop( 2 );
+  i->OStack.push( n_connected );
+  i->EStack.pop();
+}
+
+void
+mynest::LIFL_IEmodule::FetchSpikes_iFunction::execute(
+  SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 1 );
+
+  const long recorder_gid = getValue< long >( i->OStack.pick( 0 ) );
+  if ( recorder_gid <= 0
+    or static_cast< size_t >( recorder_gid )
+      >= nest::kernel().node_manager.size() )
+  {
+    throw nest::UnknownNode( recorder_gid );
+  }
+
+  // the instance on thread 0 collects the spikes of all threads
+  cursor_spike_recorder* recorder = dynamic_cast< cursor_spike_recorder* >(
+    nest::kernel().node_manager.get_node( recorder_gid, 0 ) );
+  if ( recorder == 0 )
+  {
+    throw nest::BadParameter(
+      "FetchSpikes: node is not a cursor_spike_recorder." );
+  }
+
+  const DictionaryDatum spikes = recorder->fetch();
+
+  i->OStack.pop();
+  i->OStack.push( spikes );
+  i->EStack.pop();
+}
+
+//-------------------------------------------------------------------------------------
+
 void
 mynest::LIFL_IEmodule::init( SLIInterpreter* i )
 {
@@ -112,7 +460,51 @@ mynest::LIFL_IEmodule::init( SLIInterpreter* i )
   */
   nest::kernel().model_manager.register_node_model< lifl_psc_exp_ie >(
     "lifl_psc_exp_ie" );
+  nest::kernel().model_manager.register_node_model< lifl_psc_exp >(
+    "lifl_psc_exp" );
+  nest::kernel().model_manager.register_node_model< lifl_psc_exp_ie_nofilter >(
+    "lifl_psc_exp_ie_nofilter" );
   nest::kernel().model_manager.register_node_model< aeif_psc_exp_peak >(
     "aeif_psc_exp_peak" );
+  nest::kernel().model_manager.register_node_model< trial_dc_generator >(
+    "trial_dc_generator" );
+  nest::kernel().model_manager.register_node_model< spike_file_player >(
+    "spike_file_player" );
+  nest::kernel().model_manager.register_node_model< gabor_lgn_generator >(
+    "gabor_lgn_generator" );
+  nest::kernel().model_manager.register_node_model< lfp_aggregator >(
+    "lfp_aggregator" );
+  nest::kernel().model_manager.register_node_model< meg_comparator >(
+    "meg_comparator" );
+  nest::kernel().model_manager.register_node_model< ie_recorder >(
+    "ie_recorder" );
+  nest::kernel().model_manager.register_node_model< binary_multimeter >(
+    "binary_multimeter" );
+  nest::kernel().model_manager.register_node_model< compact_spike_recorder >(
+    "compact_spike_recorder" );
+  nest::kernel().model_manager.register_node_model< cursor_spike_recorder >(
+    "cursor_spike_recorder" );
+  nest::kernel().model_manager.register_node_model< shm_recorder >(
+    "shm_recorder" );
+  nest::kernel().model_manager.register_node_model< latency_recorder >(
+    "latency_recorder" );
+
+  /* Register a SLI function.
+     The first argument is the function name for SLI, the second a pointer to
+     the function object. If you do not want to overload the function in SLI,
+     you do not need to give the mangled name. If you give a mangled name, you
+     should define a type trie in the LIFL_IEmodule-init.sli file.
+  */
+  i->createcommand( "SaveCheckpoint_s_a_b", &saveCheckpoint_s_a_bFunction );
+  i->createcommand( "RestoreCheckpoint_s", &restoreCheckpoint_sFunction );
+  i->createcommand( "ForkConditions_i_i_i", &forkConditions_i_i_iFunction );
+  i->createcommand( "FinishCondition_b", &finishCondition_bFunction );
+  i->createcommand(
+    "ConnectStimulatorGrid_a_D", &connectStimulatorGrid_a_DFunction );
+  i->createcommand( "BuildColumn_D", &buildColumn_DFunction );
+  i->createcommand(
+    "ConnectAggregator_i_a_d_d", &connectAggregator_i_a_d_dFunction );
+  i->createcommand( "ConnectIERecorder_i_a", &connectIERecorder_i_aFunction );
+  i->createcommand( "FetchSpikes_i", &fetchSpikes_iFunction );
 
 } // LIFL_IEmodule::init()
@@ -68,6 +68,239 @@ public:
    * module, in particular, set up type tries for functions you have defined.
    */
   const std::string commandstring( void ) const;
+
+public:
+  // Module functions -----------------------------------------------
+
+  /* BeginDocumentation
+     Name: SaveCheckpoint - Write the dynamic state of neurons to a file.
+
+     Synopsis:
+     (filename) [gids] incremental SaveCheckpoint -> n_records
+
+     Parameters:
+     filename    - Name of the checkpoint file; it is overwritten.
+     gids        - Array of GIDs of lifl_psc_exp_ie and aeif_psc_exp_peak
+                   neurons to save; if empty, all such neurons are saved.
+     incremental - If true, only write state that has changed since the
+                   last checkpoint written or restored by each neuron.
+
+     Description:
+     Writes membrane and synaptic state, refractoriness, IE plasticity
+     state and pending input of the given neurons to a binary checkpoint
+     file. Nodes of other models are ignored. Returns the number of node
+     records written. With MPI, each process must write its own file.
+
+     Example:
+     (warmup.ckpt) [] false SaveCheckpoint
+
+     SeeAlso: RestoreCheckpoint, checkpoint
+  */
+  class SaveCheckpoint_s_a_bFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } saveCheckpoint_s_a_bFunction;
+
+  /* BeginDocumentation
+     Name: RestoreCheckpoint - Restore the dynamic state of neurons from a file.
+
+     Synopsis:
+     (filename) RestoreCheckpoint -> n_records
+
+     Description:
+     Applies all records of a checkpoint file written by SaveCheckpoint to
+     the neurons with the same GIDs, which must exist and be of the same
+     model family. Incremental checkpoints only update the state sections
+     they contain, so they must be restored after the full checkpoint they
+     are based on. Returns the number of node records applied.
+
+     SeeAlso: SaveCheckpoint, checkpoint
+  */
+  class RestoreCheckpoint_sFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } restoreCheckpoint_sFunction;
+
+  /* BeginDocumentation
+     Name: ForkConditions - Run test conditions in forked worker processes.
+
+     Synopsis:
+     detector n_conditions max_workers ForkConditions -> condition (worker)
+                                                     -> results (parent)
+
+     Parameters:
+     detector     - GID of a spike_detector recording to memory
+     n_conditions - Number of conditions to run
+     max_workers  - Maximal number of concurrent workers, 0 for one worker
+                    per condition
+
+     Description:
+     Forks one worker per condition from the current network state. In
+     each worker, ForkConditions returns the index of the condition as an
+     integer; the worker sets up its condition, simulates and must end with
+     FinishCondition. In the parent, ForkConditions waits for all workers
+     and returns a dictionary with the arrays condition, senders and times
+     of the spikes each worker recorded. Requires a single thread and MPI
+     process.
+
+     From PyNEST, call FinishCondition in a finally clause, so that a
+     worker never returns into the rest of the script:
+
+     res = nest.sli_func('ForkConditions', det[0], 300, 8)
+     if isinstance(res, int):
+         try:
+             ... set up condition res and simulate ...
+         finally:
+             nest.sli_func('FinishCondition', False)
+
+     SeeAlso: FinishCondition, ParallelConditions, parallel_conditions
+  */
+  class ForkConditions_i_i_iFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } forkConditions_i_i_iFunction;
+
+  /* BeginDocumentation
+     Name: FinishCondition - End a worker started by ForkConditions.
+
+     Synopsis:
+     failed FinishCondition -> -
+
+     Description:
+     In a worker, hands the spikes recorded since the fork to the parent
+     and terminates the worker process; if failed is true, the parent
+     reports the condition as failed instead. Outside of a worker, does
+     nothing.
+
+     SeeAlso: ForkConditions, ParallelConditions
+  */
+  class FinishCondition_bFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } finishCondition_bFunction;
+
+  /* BeginDocumentation
+     Name: ConnectStimulatorGrid - Set the IE modulators of a grid of neurons.
+
+     Synopsis:
+     gids spec ConnectStimulatorGrid -> n_modulators
+
+     Parameters:
+     gids - lifl_psc_exp_ie neurons in row-major order
+     spec - Dictionary with rows, columns, stencil and optionally tile,
+            periodic and syn_spec, see stimulator_grid
+
+     Description:
+     Sets the stimulator list of each neuron to its grid neighbours given
+     by the stencil and, if syn_spec is given, connects each modulator to
+     the neuron. Returns the number of modulator relations set on this
+     process.
+
+     SeeAlso: stimulator_grid, lifl_psc_exp_ie
+  */
+  class ConnectStimulatorGrid_a_DFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } connectStimulatorGrid_a_DFunction;
+
+  /* BeginDocumentation
+     Name: BuildColumn - Build a network of populations from a spec.
+
+     Synopsis:
+     spec BuildColumn -> populations
+
+     Parameters:
+     spec - Dictionary with populations, projections and optionally inputs
+            and ie_grid, see column_builder
+
+     Description:
+     Creates the populations, sets their randomised initial states and
+     per-neuron values, connects the projections and the IE modulator
+     grid. Returns a dictionary mapping population names to GID arrays.
+
+     SeeAlso: column_builder, ConnectStimulatorGrid
+  */
+  class BuildColumn_DFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } buildColumn_DFunction;
+
+  /* BeginDocumentation
+     Name: ConnectAggregator - Add the synaptic currents of neurons to an LFP.
+
+     Synopsis:
+     aggregator gids weight_ex weight_in ConnectAggregator -> n_connected
+
+     Parameters:
+     aggregator - GID of an lfp_aggregator
+     gids       - lifl_psc_exp_ie or aeif_psc_exp_peak neurons
+     weight_ex  - Weight of I_syn_ex (double)
+     weight_in  - Weight of I_syn_in (double)
+
+     Description:
+     Makes each neuron add weight_ex * I_syn_ex + weight_in * I_syn_in to
+     the aggregator in every step. A neuron can be connected to several
+     aggregators, and several times to the same one. Returns the number of
+     neurons connected on this process.
+
+     SeeAlso: lfp_aggregator
+  */
+  class ConnectAggregator_i_a_d_dFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } connectAggregator_i_a_d_dFunction;
+
+  /* BeginDocumentation
+     Name: ConnectIERecorder - Record the IE changes of neurons.
+
+     Synopsis:
+     recorder gids ConnectIERecorder -> n_connected
+
+     Parameters:
+     recorder - GID of an ie_recorder
+     gids     - lifl_psc_exp_ie neurons
+
+     Description:
+     Makes each neuron report the changes of its enhancement (soma_exc)
+     to the recorder. Returns the number of neurons connected on this
+     process.
+
+     SeeAlso: ie_recorder
+  */
+  class ConnectIERecorder_i_aFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } connectIERecorder_i_aFunction;
+
+  /* BeginDocumentation
+     Name: FetchSpikes - Fetch the spikes recorded since the last fetch.
+
+     Synopsis:
+     recorder FetchSpikes -> << /senders /times >>
+
+     Parameters:
+     recorder - GID of a cursor_spike_recorder
+
+     Description:
+     Returns the spikes the recorder received since the previous call,
+     sorted by time, and drops them from the recorder, so that the cost of
+     a call does not grow with the length of the simulation.
+
+     SeeAlso: cursor_spike_recorder
+  */
+  class FetchSpikes_iFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  } fetchSpikes_iFunction;
 };
 } // namespace mynest
 
@@ -38,7 +38,6 @@
 #include "exceptions.h"
 #include "kernel_manager.h"
 #include "nest_names.h"
-#include "universal_data_logger_impl.h"
 
 // Includes from sli:
 #include "dict.h"
@@ -46,6 +45,9 @@
 #include "doubledatum.h"
 #include "integerdatum.h"
 
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
 /* ----------------------------------------------------------------
  * Recordables map
  * ---------------------------------------------------------------- */
@@ -96,32 +98,32 @@ mynest::aeif_psc_exp_peak_dynamics( double, const double y[], double f[], void*
   // good compiler will optimize the verbosity away...
 
   // Clamp membrane potential to V_reset while refractory, otherwise bound
-  // it to V_peak. Do not use V_.V_peak_ here, since that is set to V_th if
+  // it to V_peak. Do not use P_->V_peak here, since that is set to V_th if
   // Delta_T == 0.
   const double& V =
-    is_refractory ? node.P_.V_reset_ : std::min( y[ S::V_M ], node.P_.V_peak_ );
+    is_refractory ? node.P_->V_reset_ : std::min( y[ S::V_M ], node.P_->V_peak_ );
   // shorthand for the other state variables
   const double& I_syn_ex = y[ S::I_EXC ];
   const double& I_syn_in = y[ S::I_INH ];
   const double& w = y[ S::W ];
 
-  const double I_spike = node.P_.Delta_T == 0.
+  const double I_spike = node.P_->Delta_T == 0.
     ? 0.
-    : ( node.P_.g_L * node.P_.Delta_T
-        * std::exp( ( V - node.P_.V_th ) / node.P_.Delta_T ) );
+    : ( node.P_->g_L * node.P_->Delta_T
+        * std::exp( ( V - node.P_->V_th ) / node.P_->Delta_T ) );
 
   // dv/dt
   f[ S::V_M ] = is_refractory
     ? 0.
-    : ( -node.P_.g_L * ( V - node.P_.E_L ) + I_spike + I_syn_ex - I_syn_in - w
-        + node.P_.I_e + node.B_.I_stim_ ) / node.P_.C_m;
+    : ( -node.P_->g_L * ( V - node.P_->E_L ) + I_spike + I_syn_ex - I_syn_in - w
+        + node.P_->I_e + node.B_.I_stim_ ) / node.P_->C_m;
 
-  f[ S::I_EXC ] = -I_syn_ex / node.P_.tau_syn_ex; // Exc. synaptic current (pA)
+  f[ S::I_EXC ] = -I_syn_ex / node.P_->tau_syn_ex; // Exc. synaptic current (pA)
 
-  f[ S::I_INH ] = -I_syn_in / node.P_.tau_syn_in; // Inh. synaptic current (pA)
+  f[ S::I_INH ] = -I_syn_in / node.P_->tau_syn_in; // Inh. synaptic current (pA)
 
   // Adaptation current w.
-  f[ S::W ] = ( node.P_.a * ( V - node.P_.E_L ) - w ) / node.P_.tau_w;
+  f[ S::W ] = ( node.P_->a * ( V - node.P_->E_L ) - w ) / node.P_->tau_w;
 
   return GSL_SUCCESS;
 }
@@ -146,6 +148,10 @@ mynest::aeif_psc_exp_peak::Parameters_::Parameters_()
   , tau_syn_in( 2.0 ) // ms
   , I_e( 0.0 )        // pA
   , gsl_error_tol( 1e-6 )
+  , trial_period_( 0.0 )   // ms, no trial resets
+  , trial_reset_V_( -70.6 ) // mV
+  , bg_rate_( 0.0 )         // spikes/s, no background input
+  , bg_weight_( 0.0 )       // pA
 {
 }
 
@@ -202,6 +208,11 @@ mynest::aeif_psc_exp_peak::Parameters_::get( DictionaryDatum& d ) const
   def< double >( d, nest::names::I_e, I_e );
   def< double >( d, nest::names::V_peak, V_peak_ );
   def< double >( d, nest::names::gsl_error_tol, gsl_error_tol );
+  def< double >( d, names::trial_period, trial_period_ );
+  def< double >( d, names::trial_reset_V, trial_reset_V_ );
+  def< double >( d, names::bg_rate, bg_rate_ );
+  def< double >( d, names::bg_weight, bg_weight_ );
+  record_gate_.get( d );
 }
 
 void
@@ -228,6 +239,12 @@ mynest::aeif_psc_exp_peak::Parameters_::set( const DictionaryDatum& d )
 
   updateValue< double >( d, nest::names::gsl_error_tol, gsl_error_tol );
 
+  updateValue< double >( d, names::trial_period, trial_period_ );
+  updateValue< double >( d, names::trial_reset_V, trial_reset_V_ );
+  updateValue< double >( d, names::bg_rate, bg_rate_ );
+  updateValue< double >( d, names::bg_weight, bg_weight_ );
+  record_gate_.set( d );
+
   if ( V_reset_ >= V_peak_ )
   {
     throw nest::BadProperty( "Ensure that V_reset < V_peak ." );
@@ -277,6 +294,39 @@ mynest::aeif_psc_exp_peak::Parameters_::set( const DictionaryDatum& d )
   {
     throw nest::BadProperty( "The gsl_error_tol must be strictly positive." );
   }
+
+  if ( trial_period_ < 0 )
+  {
+    throw nest::BadProperty( "Ensure that trial_period >= 0" );
+  }
+
+  if ( bg_rate_ < 0 )
+  {
+    throw nest::BadProperty( "Ensure that bg_rate >= 0" );
+  }
+}
+
+bool
+mynest::aeif_psc_exp_peak::Parameters_::same_as( const Parameters_& p ) const
+{
+  return V_peak_ == p.V_peak_ && V_reset_ == p.V_reset_ && t_ref_ == p.t_ref_
+    && g_L == p.g_L && C_m == p.C_m && E_L == p.E_L && Delta_T == p.Delta_T
+    && tau_w == p.tau_w && a == p.a && b == p.b && V_th == p.V_th
+    && t_ref == p.t_ref && tau_syn_ex == p.tau_syn_ex
+    && tau_syn_in == p.tau_syn_in && I_e == p.I_e
+    && gsl_error_tol == p.gsl_error_tol && trial_period_ == p.trial_period_
+    && trial_reset_V_ == p.trial_reset_V_ && bg_rate_ == p.bg_rate_
+    && bg_weight_ == p.bg_weight_ && record_gate_ == p.record_gate_;
+}
+
+mynest::aeif_psc_exp_peak::SharedParameters_::SharedParameters_(
+  const Parameters_& p )
+  : Parameters_( p )
+  , V_peak( 0.0 )
+  , refractory_counts_( 0 )
+  , trial_steps_( 0 )
+  , h_( 0.0 )
+{
 }
 
 void
@@ -327,8 +377,8 @@ mynest::aeif_psc_exp_peak::Buffers_::Buffers_( const Buffers_&, mynest::aeif_psc
 
 mynest::aeif_psc_exp_peak::aeif_psc_exp_peak()
   : Archiving_Node()
-  , P_()
-  , S_( P_ )
+  , P_( std::make_shared< SharedParameters_ >( Parameters_() ) )
+  , S_( *P_ )
   , B_( *this )
 {
   recordablesMap_.create();
@@ -397,12 +447,12 @@ mynest::aeif_psc_exp_peak::init_buffers_()
 
   if ( B_.c_ == 0 )
   {
-    B_.c_ = gsl_odeiv_control_yp_new( P_.gsl_error_tol, P_.gsl_error_tol );
+    B_.c_ = gsl_odeiv_control_yp_new( P_->gsl_error_tol, P_->gsl_error_tol );
   }
   else
   {
     gsl_odeiv_control_init(
-      B_.c_, P_.gsl_error_tol, P_.gsl_error_tol, 0.0, 1.0 );
+      B_.c_, P_->gsl_error_tol, P_->gsl_error_tol, 0.0, 1.0 );
   }
 
   if ( B_.e_ == 0 )
@@ -420,33 +470,71 @@ mynest::aeif_psc_exp_peak::init_buffers_()
   B_.sys_.function = aeif_psc_exp_peak_dynamics;
 
   B_.I_stim_ = 0.0;
+
+  // pending input restored from a checkpoint before the first Simulate
+  if ( ckpt_.has_deferred_buffers() )
+  {
+    CheckpointBuffer b = ckpt_.take_deferred_buffers();
+    restore_buffers_( b );
+  }
+  ckpt_.set_buffers_ready();
 }
 
 void
 mynest::aeif_psc_exp_peak::calibrate()
 {
   // ensures initialization in case mm connected after Simulate
-  B_.logger_.init();
+  B_.logger_.init( P_->record_gate_ );
+
+  P_->calibrate( nest::Time::get_resolution().get_ms() );
+
+  B_.bg_dev_.set_lambda( P_->bg_rate_ * P_->h_ * 1e-3 );
+}
+
+void
+mynest::aeif_psc_exp_peak::SharedParameters_::calibrate( double h )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  // computed once for all nodes sharing the parameters
+  if ( h_ == h )
+  {
+    return;
+  }
 
   // set the right threshold and GSL function depending on Delta_T
-  if ( P_.Delta_T > 0. )
+  if ( Delta_T > 0. )
   {
-    V_.V_peak = P_.V_peak_;
+    V_peak = V_peak_;
   }
   else
   {
-    V_.V_peak = P_.V_th; // same as IAF dynamics for spikes if Delta_T == 0.
+    V_peak = V_th; // same as IAF dynamics for spikes if Delta_T == 0.
   }
 
-  V_.refractory_counts_ = nest::Time( nest::Time::ms( P_.t_ref_ ) ).get_steps();
+  refractory_counts_ = nest::Time( nest::Time::ms( t_ref_ ) ).get_steps();
   // since t_ref_ >= 0, this can only fail in error
-  assert( V_.refractory_counts_ >= 0 );
+  assert( refractory_counts_ >= 0 );
+
+  trial_steps_ = nest::Time( nest::Time::ms( trial_period_ ) ).get_steps();
+
+  h_ = h;
 }
 
 /* ----------------------------------------------------------------
  * Update and spike handling functions
  * ---------------------------------------------------------------- */
 
+void
+mynest::aeif_psc_exp_peak::reset_trial_()
+{
+  // the adaptation current is kept across trials
+  S_.y_[ State_::V_M ] = P_->trial_reset_V_;
+  S_.y_[ State_::I_EXC ] = 0.0;
+  S_.y_[ State_::I_INH ] = 0.0;
+  S_.r_ = 0;
+}
+
 void
 mynest::aeif_psc_exp_peak::update( const nest::Time& origin, const long from, const long to )
 {
@@ -455,13 +543,21 @@ mynest::aeif_psc_exp_peak::update( const nest::Time& origin, const long from, co
   assert( from < to );
   assert( State_::V_M == 0 );
 
+  librandom::RngPtr rng = nest::kernel().rng_manager.get_rng( get_thread() );
+
   for ( long lag = from; lag < to; ++lag )
   {
+    // trial boundaries are multiples of the trial period after time 0
+    const long step = origin.get_steps() + lag;
+    if ( P_->trial_steps_ > 0 && step > 0 && step % P_->trial_steps_ == 0 )
+    {
+      reset_trial_();
+    }
 
-	//if ( S_.y_[ State_::V_M ] == V_.refractory_counts_ )
+	//if ( S_.y_[ State_::V_M ] == P_->refractory_counts_ )
 	//if ( S_.y_[ State_::V_M ] == 10.0 )
 	//{
-	//	S_.y_[ State_::V_M ] = P_.V_reset_;
+	//	S_.y_[ State_::V_M ] = P_->V_reset_;
 	//}
 
 
@@ -503,11 +599,11 @@ mynest::aeif_psc_exp_peak::update( const nest::Time& origin, const long from, co
       // due to spike-driven adaptation
       if ( S_.r_ > 0 )
       {
-        S_.y_[ State_::V_M ] = P_.V_reset_;
+        S_.y_[ State_::V_M ] = P_->V_reset_;
       }
-      else if ( S_.y_[ State_::V_M ] >= V_.V_peak ) // If V_m is on peak, reset V_m.
+      else if ( S_.y_[ State_::V_M ] >= P_->V_peak ) // If V_m is on peak, reset V_m.
       {
-        S_.y_[ State_::W ] += P_.b; // spike-driven adaptation
+        S_.y_[ State_::W ] += P_->b; // spike-driven adaptation
 
         /* Initialize refractory step counter.
          * - We need to add 1 to compensate for count-down immediately after
@@ -515,13 +611,13 @@ mynest::aeif_psc_exp_peak::update( const nest::Time& origin, const long from, co
          * - If neuron has no refractory time, set to 0 to avoid refractory
          *   artifact inside while loop.
          */
-        S_.r_ = V_.refractory_counts_ > 0 ? V_.refractory_counts_ + 1 : 0;
+        S_.r_ = P_->refractory_counts_ > 0 ? P_->refractory_counts_ + 1 : 0;
 
         set_spiketime( nest::Time::step( origin.get_steps() + lag + 1 ) );
         nest::SpikeEvent se;
         nest::kernel().event_delivery_manager.send( *this, se, lag );
 	
-	if ( S_.r_ ==  V_.refractory_counts_ )
+	if ( S_.r_ ==  P_->refractory_counts_ )
 	{
 		S_.y_[ State_::V_M ] = 10.0;
 	}
@@ -532,13 +628,13 @@ mynest::aeif_psc_exp_peak::update( const nest::Time& origin, const long from, co
     // decrement refractory count
     if ( S_.r_ > 0 )
     {
-	if ( S_.r_ ==  V_.refractory_counts_ )  // V_m is on peak at first refractory count 
+	if ( S_.r_ ==  P_->refractory_counts_ )  // V_m is on peak at first refractory count 
 	{
 		S_.y_[ State_::V_M ] = 10.0;
 	}
 	else
 	{
-      		S_.y_[ State_::V_M ] = P_.V_reset_;
+      		S_.y_[ State_::V_M ] = P_->V_reset_;
 	}
 
       --S_.r_;
@@ -547,11 +643,31 @@ mynest::aeif_psc_exp_peak::update( const nest::Time& origin, const long from, co
     S_.y_[ State_::I_EXC ] += B_.spike_exc_.get_value( lag );
     S_.y_[ State_::I_INH ] += B_.spike_inh_.get_value( lag );
 
+    // background input, added like the spikes of a poisson_generator
+    if ( P_->bg_rate_ > 0.0 )
+    {
+      const double bg = P_->bg_weight_ * B_.bg_dev_.ldev( rng );
+      if ( bg > 0.0 )
+      {
+        S_.y_[ State_::I_EXC ] += bg;
+      }
+      else
+      {
+        S_.y_[ State_::I_INH ] -= bg; // keep conductances positive
+      }
+    }
+
     // set new input current
     B_.I_stim_ = B_.currents_.get_value( lag );
 
     // log state data
     B_.logger_.record_data( origin.get_steps() + lag );
+    if ( not aggregators_.empty() )
+    {
+      aggregators_.record( origin.get_steps() + lag,
+        S_.y_[ State_::I_EXC ],
+        S_.y_[ State_::I_INH ] );
+    }
   }
 }
 
@@ -594,4 +710,106 @@ mynest::aeif_psc_exp_peak::handle( nest::DataLoggingRequest& e )
   B_.logger_.handle( e );
 }
 
+void
+mynest::aeif_psc_exp_peak::connect_aggregator( lfp_aggregator& aggregator,
+  double weight_ex,
+  double weight_in )
+{
+  aggregators_.add( aggregator, weight_ex, weight_in );
+}
+
+/* ----------------------------------------------------------------
+ * Checkpointing
+ * ---------------------------------------------------------------- */
+
+void
+mynest::aeif_psc_exp_peak::save_checkpoint( CheckpointWriter& w )
+{
+  w.begin_node( get_gid(), "aeif_psc_exp_peak" );
+
+  CheckpointBuffer dyn;
+  save_dynamics_( dyn );
+  w.section( CKPT_DYNAMICS, dyn, ckpt_ );
+
+  if ( ckpt_.buffers_ready() )
+  {
+    CheckpointBuffer buf;
+    save_buffers_( buf );
+    w.section( CKPT_BUFFERS, buf, ckpt_ );
+  }
+
+  w.end_node();
+}
+
+void
+mynest::aeif_psc_exp_peak::restore_checkpoint( const CheckpointReader& r )
+{
+  if ( r.family() != "aeif_psc_exp_peak" )
+  {
+    throw CheckpointError( "Checkpoint record of node "
+      + std::to_string( get_gid() ) + " was written by " + r.family() + "." );
+  }
+
+  if ( r.has_section( CKPT_DYNAMICS ) )
+  {
+    // read into a temporary, so that a corrupt record leaves S_ untouched
+    State_ stmp = S_;
+    CheckpointBuffer dyn = r.get_section( CKPT_DYNAMICS );
+    for ( size_t i = 0; i < State_::STATE_VEC_SIZE; ++i )
+    {
+      dyn.get( stmp.y_[ i ] );
+    }
+    dyn.get( stmp.r_ );
+    S_ = stmp;
+  }
+
+  if ( r.has_section( CKPT_BUFFERS ) )
+  {
+    CheckpointBuffer buf = r.get_section( CKPT_BUFFERS );
+    if ( ckpt_.buffers_ready() )
+    {
+      restore_buffers_( buf );
+    }
+    else
+    {
+      ckpt_.defer_buffers( buf ); // applied by init_buffers_()
+    }
+  }
+
+  // the next incremental checkpoint is relative to the restored state
+  CheckpointBuffer dyn;
+  save_dynamics_( dyn );
+  ckpt_.mark( CKPT_DYNAMICS, dyn );
+}
+
+void
+mynest::aeif_psc_exp_peak::save_dynamics_( CheckpointBuffer& b ) const
+{
+  for ( size_t i = 0; i < State_::STATE_VEC_SIZE; ++i )
+  {
+    b.put( S_.y_[ i ] );
+  }
+  b.put( S_.r_ );
+}
+
+void
+mynest::aeif_psc_exp_peak::save_buffers_( CheckpointBuffer& b ) const
+{
+  B_.spike_exc_.save( b );
+  B_.spike_inh_.save( b );
+  B_.currents_.save( b );
+  b.put( B_.IntegrationStep_ );
+  b.put( B_.I_stim_ );
+}
+
+void
+mynest::aeif_psc_exp_peak::restore_buffers_( CheckpointBuffer& b )
+{
+  B_.spike_exc_.restore( b );
+  B_.spike_inh_.restore( b );
+  B_.currents_.restore( b );
+  b.get( B_.IntegrationStep_ );
+  b.get( B_.I_stim_ );
+}
+
 #endif // HAVE_GSL
@@ -28,6 +28,10 @@
 
 #ifdef HAVE_GSL
 
+// C++ includes:
+#include <memory>
+#include <mutex>
+
 // External includes:
 #include <gsl/gsl_errno.h>
 #include <gsl/gsl_matrix.h>
@@ -40,7 +44,15 @@
 #include "nest_types.h"
 #include "recordables_map.h"
 #include "ring_buffer.h"
-#include "universal_data_logger.h"
+
+// Includes from librandom:
+#include "poisson_randomdev.h"
+
+// Includes from LIFL_IE:
+#include "checkpoint.h"
+#include "checkpoint_ring_buffer.h"
+#include "gated_data_logger.h"
+#include "lfp_aggregator.h"
 
 /* BeginDocumentation
 Name: aeif_psc_exp - Current-based exponential integrate-and-fire neuron
@@ -98,11 +110,45 @@ Synaptic parameters
   tau_syn_in double - Rise time of the inhibitory synaptic conductance in ms
                       (exp function).
 
+Trial reset
+  trial_period   double - Period of trial resets in ms, 0 disables them.
+  trial_reset_V  double - Membrane potential after a trial reset in mV.
+
+At every multiple of trial_period after time 0, V_m is set to
+trial_reset_V and the synaptic currents and refractoriness are cleared.
+The adaptation current w is kept.
+
+Background input
+  bg_rate    double - Rate of background input spikes in spikes/s, 0
+                      disables it.
+  bg_weight  double - Weight of a background input spike in pA, negative
+                      for inhibitory input.
+
+The background input is equivalent to a poisson_generator of rate bg_rate
+connected with weight bg_weight, but the number of input spikes in each
+step is drawn inside the neuron, so no spike events are delivered.
+
+Recording windows
+  record_windows  double array - start, stop pairs of the windows (ms) in
+                                 which multimeters sample the neuron;
+                                 empty to sample always.
+  record_period   double       - Period of the windows in ms, 0 if they
+                                 are in absolute time.
+
+Outside the windows, nothing is read, stored or sent to the multimeters.
+
 Integration parameters
   gsl_error_tol  double - This parameter controls the admissible error of the
                           GSL integrator. Reduce it if NEST complains about
                           numerical instabilities.
 
+Checkpointing:
+The state vector, refractoriness, the integrator step size and pending
+input can be saved and restored with SaveCheckpoint and RestoreCheckpoint.
+
+Nodes created from the same model share one copy of their parameters;
+setting a parameter of a single node gives it its own copy.
+
 Author: Tanguy Fardet
 
 Sends: SpikeEvent
@@ -113,7 +159,7 @@ References: Brette R and Gerstner W (2005) Adaptive Exponential
             Integrate-and-Fire Model as an Effective Description of
             Neuronal Activity. J Neurophysiol 94:3637-3642
 
-SeeAlso: iaf_psc_exp, aeif_cond_exp
+SeeAlso: iaf_psc_exp, aeif_cond_exp, SaveCheckpoint, RestoreCheckpoint
 */
 
 namespace mynest
@@ -130,7 +176,9 @@ namespace mynest
  */
 extern "C" int aeif_psc_exp_peak_dynamics( double, const double*, double*, void* );
 
-class aeif_psc_exp_peak : public nest::Archiving_Node
+class aeif_psc_exp_peak : public nest::Archiving_Node,
+                          public Checkpointable,
+                          public AggregatorSource
 {
 
 public:
@@ -159,12 +207,24 @@ public:
   void get_status( DictionaryDatum& ) const;
   void set_status( const DictionaryDatum& );
 
+  void save_checkpoint( CheckpointWriter& );
+  void restore_checkpoint( const CheckpointReader& );
+
+  void connect_aggregator( lfp_aggregator&, double, double );
+
 private:
   void init_state_( const Node& proto );
   void init_buffers_();
   void calibrate();
   void update( const nest::Time&, const long, const long );
 
+  //! Reset membrane and synaptic state at a trial boundary
+  void reset_trial_();
+
+  void save_dynamics_( CheckpointBuffer& ) const;
+  void save_buffers_( CheckpointBuffer& ) const;
+  void restore_buffers_( CheckpointBuffer& );
+
   // END Boilerplate function declarations ----------------------------
 
   // Friends --------------------------------------------------------
@@ -174,7 +234,7 @@ private:
 
   // The next two classes need to be friends to access the State_ class/member
   friend class nest::RecordablesMap< aeif_psc_exp_peak >;
-  friend class nest::UniversalDataLogger< aeif_psc_exp_peak >;
+  friend class GatedDataLogger< aeif_psc_exp_peak >;
 
 private:
   // ----------------------------------------------------------------
@@ -201,10 +261,54 @@ private:
 
     double gsl_error_tol; //!< error bound for GSL integrator
 
+    double trial_period_;  //!< Period of trial resets in ms, 0 for none
+    double trial_reset_V_; //!< Membrane potential after trial reset in mV
+
+    double bg_rate_;   //!< Rate of background input spikes in spikes/s
+    double bg_weight_; //!< Weight of a background input spike in pA
+
+    RecordingGate record_gate_; //!< Windows in which recordables are sampled
+
     Parameters_(); //!< Sets default parameter values
 
     void get( DictionaryDatum& ) const; //!< Store current values in dictionary
     void set( const DictionaryDatum& ); //!< Set values from dicitonary
+
+    //! True if all parameters are equal
+    bool same_as( const Parameters_& ) const;
+  };
+
+  // ----------------------------------------------------------------
+
+  /**
+   * Parameters together with the internal variables computed from them.
+   * All nodes created from the same prototype share one instance; a node
+   * gets its own copy only when set_status changes one of its parameters.
+   */
+  struct SharedParameters_ : public Parameters_
+  {
+    explicit SharedParameters_( const Parameters_& );
+
+    /** Compute internal variables for resolution h unless already done.
+     * Nodes sharing the instance may be calibrated by different threads.
+     */
+    void calibrate( double h );
+
+    /**
+     * Threshold detection for spike events: P.V_peak if Delta_T > 0.,
+     * P.V_th if Delta_T == 0.
+     */
+    double V_peak;
+
+    unsigned int refractory_counts_;
+
+    long trial_steps_; //!< trial period in steps, 0 for no trial resets
+
+    //! Resolution in ms the variables were computed for, 0 if not yet
+    double h_;
+
+  private:
+    std::mutex mutex_;
   };
 
 public:
@@ -255,12 +359,15 @@ public:
     Buffers_( const Buffers_&, aeif_psc_exp_peak& ); //!<Sets buffer pointers to 0
 
     //! Logger for all analog data
-    nest::UniversalDataLogger< aeif_psc_exp_peak > logger_;
+    GatedDataLogger< aeif_psc_exp_peak > logger_;
 
     /** buffers and sums up incoming spikes/currents */
-    nest::RingBuffer spike_exc_;
-    nest::RingBuffer spike_inh_;
-    nest::RingBuffer currents_;
+    CheckpointRingBuffer spike_exc_;
+    CheckpointRingBuffer spike_inh_;
+    CheckpointRingBuffer currents_;
+
+    //! Number of background input spikes per step
+    librandom::PoissonRandomDev bg_dev_;
 
     /** GSL ODE stuff */
     gsl_odeiv_step* s_;    //!< stepping function
@@ -285,22 +392,6 @@ public:
     double I_stim_;
   };
 
-  // ----------------------------------------------------------------
-
-  /**
-   * Internal variables of the model.
-   */
-  struct Variables_
-  {
-    /**
-     * Threshold detection for spike events: P.V_peak if Delta_T > 0.,
-     * P.V_th if Delta_T == 0.
-     */
-    double V_peak;
-
-    unsigned int refractory_counts_;
-  };
-
   // Access functions for UniversalDataLogger -------------------------------
 
   //! Read out state vector elements, used by UniversalDataLogger
@@ -313,11 +404,16 @@ public:
 
   // ----------------------------------------------------------------
 
-  Parameters_ P_;
+  std::shared_ptr< SharedParameters_ > P_; //!< shared, copied on write
   State_ S_;
-  Variables_ V_;
   Buffers_ B_;
 
+  //! Checkpoint bookkeeping
+  CheckpointState ckpt_;
+
+  //! LFP aggregators the synaptic currents are added to
+  AggregatorTargets aggregators_;
+
   //! Mapping of recordables names to access functions
   static nest::RecordablesMap< aeif_psc_exp_peak > recordablesMap_;
 };
@@ -367,7 +463,7 @@ mynest::aeif_psc_exp_peak::handles_test_event( nest::DataLoggingRequest& dlr, ne
 inline void
 aeif_psc_exp_peak::get_status( DictionaryDatum& d ) const
 {
-  P_.get( d );
+  P_->get( d );
   S_.get( d );
   Archiving_Node::get_status( d );
 
@@ -377,7 +473,7 @@ aeif_psc_exp_peak::get_status( DictionaryDatum& d ) const
 inline void
 aeif_psc_exp_peak::set_status( const DictionaryDatum& d )
 {
-  Parameters_ ptmp = P_; // temporary copy in case of errors
+  Parameters_ ptmp = *P_; // temporary copy in case of errors
   ptmp.set( d );         // throws if BadProperty
   State_ stmp = S_;      // temporary copy in case of errors
   stmp.set( d, ptmp );   // throws if BadProperty
@@ -388,8 +484,12 @@ aeif_psc_exp_peak::set_status( const DictionaryDatum& d )
   // consistent.
   Archiving_Node::set_status( d );
 
-  // if we get here, temporaries contain consistent set of properties
-  P_ = ptmp;
+  // if we get here, temporaries contain consistent set of properties;
+  // other nodes keep the shared parameters if only the state was changed
+  if ( not ptmp.same_as( *P_ ) )
+  {
+    P_ = std::make_shared< SharedParameters_ >( ptmp );
+  }
   S_ = stmp;
 }
 
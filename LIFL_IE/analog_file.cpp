@@ -0,0 +1,272 @@
+/*
+ *  analog_file.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "analog_file.h"
+
+// C++ includes:
+#include <cstring>
+#include <limits>
+
+// Includes from nestkernel:
+#include "nest_time.h"
+
+namespace
+{
+const char analog_file_magic[ 8 ] = { 'L', 'I', 'F', 'L', 'A', 'N', 'L', 'G' };
+const unsigned int analog_file_version = 1;
+const size_t analog_file_name_length = 32;
+
+/**
+ * Fixed part of the header of an analog file, as stored on disk.
+ */
+struct AnalogFileHeader
+{
+  char magic[ 8 ];
+  unsigned int version;
+  unsigned int n_recordables;
+  unsigned long n_neurons;
+  double interval;
+};
+}
+
+std::string
+mynest::AnalogFileError::message() const
+{
+  return msg_;
+}
+
+/* ----------------------------------------------------------------
+ * Chunks
+ * ---------------------------------------------------------------- */
+
+mynest::AnalogChunk::AnalogChunk()
+  : n_columns_( 0 )
+  , n_rows_( 0 )
+  , first_stamp_( 0 )
+  , interval_steps_( 1 )
+  , data_()
+  , used_()
+{
+}
+
+void
+mynest::AnalogChunk::reset( const size_t n_columns,
+  const size_t n_rows,
+  const long first_stamp,
+  const long interval_steps )
+{
+  n_columns_ = n_columns;
+  n_rows_ = n_rows;
+  first_stamp_ = first_stamp;
+  interval_steps_ = interval_steps;
+
+  // samples not sent by a neuron read as NaN
+  data_.assign(
+    n_columns * n_rows, std::numeric_limits< double >::quiet_NaN() );
+  used_.assign( n_rows, false );
+}
+
+bool
+mynest::AnalogChunk::empty() const
+{
+  return std::find( used_.begin(), used_.end(), true ) == used_.end();
+}
+
+void
+mynest::AnalogChunk::swap( AnalogChunk& c )
+{
+  std::swap( n_columns_, c.n_columns_ );
+  std::swap( n_rows_, c.n_rows_ );
+  std::swap( first_stamp_, c.first_stamp_ );
+  std::swap( interval_steps_, c.interval_steps_ );
+  data_.swap( c.data_ );
+  used_.swap( c.used_ );
+}
+
+/* ----------------------------------------------------------------
+ * Writer
+ * ---------------------------------------------------------------- */
+
+mynest::AnalogFileWriter::AnalogFileWriter( const std::string& filename,
+  const std::vector< Name >& record_from,
+  const std::vector< long >& gids,
+  const double interval )
+  : filename_( filename )
+  , file_( std::fopen( filename.c_str(), "wb" ) )
+  , mutex_()
+  , cond_()
+  , back_()
+  , pending_( false )
+  , stop_( false )
+  , failed_( false )
+  , times_()
+  , thread_()
+{
+  if ( file_ == 0 )
+  {
+    throw AnalogFileError( "Cannot open analog file " + filename
+      + " for writing." );
+  }
+
+  AnalogFileHeader header;
+  std::memset( &header, 0, sizeof( header ) );
+  std::memcpy( header.magic, analog_file_magic, sizeof( header.magic ) );
+  header.version = analog_file_version;
+  header.n_recordables = record_from.size();
+  header.n_neurons = gids.size();
+  header.interval = interval;
+
+  bool ok = std::fwrite( &header, sizeof( header ), 1, file_ ) == 1;
+  for ( size_t j = 0; j < record_from.size(); ++j )
+  {
+    char name[ analog_file_name_length ];
+    std::memset( name, 0, sizeof( name ) );
+    std::strncpy( name, record_from[ j ].toString().c_str(), sizeof( name ) );
+    ok = ok and std::fwrite( name, sizeof( name ), 1, file_ ) == 1;
+  }
+  const std::vector< unsigned long > gid_records( gids.begin(), gids.end() );
+  ok = ok
+    and std::fwrite( gid_records.data(),
+          sizeof( unsigned long ),
+          gid_records.size(),
+          file_ ) == gid_records.size();
+  if ( not ok )
+  {
+    std::fclose( file_ );
+    throw AnalogFileError( "Cannot write analog file " + filename + "." );
+  }
+
+  thread_ = std::thread( &AnalogFileWriter::run_, this );
+}
+
+mynest::AnalogFileWriter::~AnalogFileWriter()
+{
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    stop_ = true;
+  }
+  cond_.notify_all();
+  thread_.join(); // writes a pending chunk first
+  std::fclose( file_ );
+}
+
+void
+mynest::AnalogFileWriter::submit( AnalogChunk& chunk )
+{
+  std::unique_lock< std::mutex > lock( mutex_ );
+  cond_.wait( lock, [this] { return not pending_; } );
+  check_error_();
+
+  back_.swap( chunk );
+  pending_ = true;
+  lock.unlock();
+  cond_.notify_all();
+}
+
+void
+mynest::AnalogFileWriter::flush()
+{
+  std::unique_lock< std::mutex > lock( mutex_ );
+  cond_.wait( lock, [this] { return not pending_; } );
+  if ( std::fflush( file_ ) != 0 )
+  {
+    failed_ = true;
+  }
+  check_error_();
+}
+
+void
+mynest::AnalogFileWriter::check_error_() const
+{
+  if ( failed_ )
+  {
+    throw AnalogFileError( "Writing analog file " + filename_ + " failed." );
+  }
+}
+
+void
+mynest::AnalogFileWriter::run_()
+{
+  std::unique_lock< std::mutex > lock( mutex_ );
+  while ( true )
+  {
+    cond_.wait( lock, [this] { return pending_ or stop_; } );
+    if ( not pending_ )
+    {
+      return; // stopped
+    }
+
+    // back_ is not touched by submit() while pending_ is set
+    lock.unlock();
+    const bool ok = write_( back_ );
+    lock.lock();
+
+    failed_ = failed_ or not ok;
+    pending_ = false;
+    cond_.notify_all();
+  }
+}
+
+bool
+mynest::AnalogFileWriter::write_( const AnalogChunk& chunk )
+{
+  times_.clear();
+  for ( size_t r = 0; r < chunk.n_rows_; ++r )
+  {
+    if ( chunk.used_[ r ] )
+    {
+      const long stamp = chunk.first_stamp_ + r * chunk.interval_steps_;
+      times_.push_back( nest::Time( nest::Time::step( stamp ) ).get_ms() );
+    }
+  }
+  if ( times_.empty() )
+  {
+    return true;
+  }
+
+  const unsigned long n_rows = times_.size();
+  bool ok = std::fwrite( &n_rows, sizeof( n_rows ), 1, file_ ) == 1
+    and std::fwrite( times_.data(), sizeof( double ), n_rows, file_ ) == n_rows;
+
+  // the used rows of each column; whole columns if all rows are used
+  std::vector< double > column( n_rows );
+  for ( size_t c = 0; ok and c < chunk.n_columns_; ++c )
+  {
+    const double* src = &chunk.data_[ c * chunk.n_rows_ ];
+    if ( n_rows == chunk.n_rows_ )
+    {
+      ok = std::fwrite( src, sizeof( double ), n_rows, file_ ) == n_rows;
+      continue;
+    }
+    size_t k = 0;
+    for ( size_t r = 0; r < chunk.n_rows_; ++r )
+    {
+      if ( chunk.used_[ r ] )
+      {
+        column[ k++ ] = src[ r ];
+      }
+    }
+    ok =
+      std::fwrite( column.data(), sizeof( double ), n_rows, file_ ) == n_rows;
+  }
+  return ok;
+}
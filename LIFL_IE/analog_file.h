@@ -0,0 +1,217 @@
+/*
+ *  analog_file.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANALOG_FILE_H
+#define ANALOG_FILE_H
+
+// C++ includes:
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+
+// Includes from sli:
+#include "name.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: analog_file - Binary file of analog recordings.
+
+   Description:
+   An analog file holds recordables of a number of neurons, sampled on a
+   common time grid, as written by binary_multimeter. The samples are
+   stored in chunks, column by column, so that each column of a chunk is
+   a contiguous array that can be mapped, e.g. with numpy.memmap, without
+   parsing. read_analog_file in Examples/lifl_ie_io.py reads it.
+
+   File layout (all values in native byte order):
+     header : char[8] "LIFLANLG", uint32 version, uint32 number of
+              recordables, uint64 number of neurons, double sampling
+              interval in ms, char[32] name of each recordable (padded
+              with NUL), uint64 GID of each neuron in increasing order
+     chunk  : uint64 number of rows n, double[n] times in ms, then one
+              double[n] per column; column i * (number of recordables)
+              + j holds recordable j of neuron i
+   Chunks follow each other up to the end of the file; their times are
+   increasing. Samples a neuron did not send, e.g. outside its recording
+   windows, are NaN; times at which no neuron was sampled are left out.
+
+   SeeAlso: binary_multimeter
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Exception thrown if an analog file cannot be written.
+ */
+class AnalogFileError : public nest::KernelException
+{
+public:
+  AnalogFileError( const std::string& msg )
+    : KernelException( "AnalogFileError" )
+    , msg_( msg )
+  {
+  }
+
+  ~AnalogFileError() throw()
+  {
+  }
+
+  std::string message() const;
+
+private:
+  std::string msg_;
+};
+
+/**
+ * Samples of all columns of an analog file at a range of time stamps on
+ * the sampling grid, stored column by column.
+ */
+class AnalogChunk
+{
+public:
+  AnalogChunk();
+
+  /**
+   * Clear the chunk and let it cover n_rows time stamps, interval_steps
+   * apart, beginning with first_stamp.
+   */
+  void reset( size_t n_columns,
+    size_t n_rows,
+    long first_stamp,
+    long interval_steps );
+
+  size_t
+  n_rows() const
+  {
+    return n_rows_;
+  }
+
+  //! First time stamp after the chunk
+  long
+  end_stamp() const
+  {
+    return first_stamp_ + static_cast< long >( n_rows_ ) * interval_steps_;
+  }
+
+  //! Row of a time stamp, n_rows() if the chunk does not cover it
+  size_t
+  row_of( const long stamp ) const
+  {
+    const long offset = stamp - first_stamp_;
+    if ( offset < 0 or offset % interval_steps_ != 0 )
+    {
+      return n_rows_;
+    }
+    return std::min( static_cast< size_t >( offset / interval_steps_ ),
+      n_rows_ );
+  }
+
+  void
+  set( const size_t row, const size_t column, const double value )
+  {
+    data_[ column * n_rows_ + row ] = value;
+    used_[ row ] = true;
+  }
+
+  //! True if no row has been set
+  bool empty() const;
+
+  void swap( AnalogChunk& );
+
+private:
+  friend class AnalogFileWriter;
+
+  size_t n_columns_;
+  size_t n_rows_;
+  long first_stamp_;
+  long interval_steps_;
+  std::vector< double > data_; //!< n_rows_ values per column
+  std::vector< char > used_;   //!< rows set since the last reset
+};
+
+/**
+ * Writer of an analog file with a background thread.
+ *
+ * The header is written when the file is opened. Chunks are handed over
+ * with submit() and written by the writer thread, which drops the unused
+ * rows; the caller only waits if the previous chunk is still being
+ * written, never for the disk otherwise.
+ */
+class AnalogFileWriter
+{
+public:
+  AnalogFileWriter( const std::string& filename,
+    const std::vector< Name >& record_from,
+    const std::vector< long >& gids,
+    double interval );
+
+  //! Write the remaining chunk and close the file
+  ~AnalogFileWriter();
+
+  const std::string&
+  filename() const
+  {
+    return filename_;
+  }
+
+  /**
+   * Pass a chunk to the writer thread. On return, chunk holds the
+   * previously written chunk, to be reset and refilled.
+   */
+  void submit( AnalogChunk& chunk );
+
+  //! Wait until all chunks submitted have reached the file
+  void flush();
+
+private:
+  AnalogFileWriter( const AnalogFileWriter& );            //!< not implemented
+  AnalogFileWriter& operator=( const AnalogFileWriter& ); //!< not implemented
+
+  void run_();
+  bool write_( const AnalogChunk& );
+  void check_error_() const; //!< call with mutex_ held
+
+  std::string filename_;
+  std::FILE* file_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  AnalogChunk back_; //!< chunk being written
+  bool pending_;     //!< back_ holds a chunk not yet written
+  bool stop_;
+  bool failed_;
+  std::vector< double > times_; //!< times of the used rows, writer only
+
+  std::thread thread_;
+};
+
+} // namespace mynest
+
+#endif // ANALOG_FILE_H
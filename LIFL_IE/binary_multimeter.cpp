@@ -0,0 +1,302 @@
+/*
+ *  binary_multimeter.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "binary_multimeter.h"
+
+// C++ includes:
+#include <algorithm>
+#include <sstream>
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+#include "namedatum.h"
+#include "stringdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters
+ * ---------------------------------------------------------------- */
+
+mynest::binary_multimeter::Parameters_::Parameters_()
+  : filename_( "binary_multimeter" )
+  , record_from_()
+  , interval_( nest::Time::ms( 1.0 ) )
+  , chunk_rows_( 1024 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::binary_multimeter::Parameters_::get( DictionaryDatum& d ) const
+{
+  ( *d )[ names::filename ] = filename_;
+
+  ArrayDatum record_from;
+  for ( size_t j = 0; j < record_from_.size(); ++j )
+  {
+    record_from.push_back( LiteralDatum( record_from_[ j ] ) );
+  }
+  ( *d )[ nest::names::record_from ] = record_from;
+
+  def< double >( d, nest::names::interval, interval_.get_ms() );
+  def< long >( d, names::chunk_rows, chunk_rows_ );
+}
+
+void
+mynest::binary_multimeter::Parameters_::set( const DictionaryDatum& d,
+  const bool connected )
+{
+  updateValue< std::string >( d, names::filename, filename_ );
+
+  if ( d->known( nest::names::record_from ) )
+  {
+    if ( connected )
+    {
+      throw nest::BadProperty(
+        "record_from cannot be changed once neurons are connected." );
+    }
+    const ArrayDatum record_from =
+      getValue< ArrayDatum >( d, nest::names::record_from );
+    record_from_.clear();
+    for ( size_t j = 0; j < record_from.size(); ++j )
+    {
+      record_from_.push_back(
+        Name( getValue< std::string >( record_from[ j ] ) ) );
+    }
+  }
+
+  double interval;
+  if ( updateValue< double >( d, nest::names::interval, interval ) )
+  {
+    if ( connected )
+    {
+      throw nest::BadProperty(
+        "interval cannot be changed once neurons are connected." );
+    }
+    if ( interval < nest::Time::get_resolution().get_ms() )
+    {
+      throw nest::BadProperty(
+        "interval must be at least the simulation resolution." );
+    }
+    interval_ = nest::Time( nest::Time::ms( interval ) );
+    if ( not interval_.is_step() )
+    {
+      throw nest::BadProperty(
+        "interval must be a multiple of the simulation resolution." );
+    }
+  }
+
+  updateValue< long >( d, names::chunk_rows, chunk_rows_ );
+  if ( filename_.empty() )
+  {
+    throw nest::BadProperty( "filename must not be empty." );
+  }
+  if ( chunk_rows_ < 1 )
+  {
+    throw nest::BadProperty( "chunk_rows must be positive." );
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::binary_multimeter::binary_multimeter()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , B_()
+  , V_()
+  , targets_()
+{
+}
+
+mynest::binary_multimeter::binary_multimeter( const binary_multimeter& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , B_()
+  , V_()
+  , targets_()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::binary_multimeter::init_state_( const Node& proto )
+{
+  const binary_multimeter& pr = downcast< binary_multimeter >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::binary_multimeter::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::binary_multimeter::calibrate()
+{
+  device_.calibrate();
+
+  if ( targets_.empty() )
+  {
+    return;
+  }
+
+  std::ostringstream filename;
+  filename << P_.filename_ << "-" << get_vp() << ".dat";
+  if ( B_.writer_ and B_.writer_->filename() == filename.str() )
+  {
+    return; // continue the file of the previous simulation
+  }
+
+  // the columns of each neuron, in the order of the GIDs
+  std::sort( targets_.begin(), targets_.end() );
+  V_.column_of_.clear();
+  for ( size_t k = 0; k < targets_.size(); ++k )
+  {
+    V_.column_of_[ targets_[ k ] ] = k * P_.record_from_.size();
+  }
+  V_.n_columns_ = targets_.size() * P_.record_from_.size();
+
+  // a chunk holds at least the samples of one slice
+  V_.interval_steps_ = P_.interval_.get_steps();
+  const long min_delay = nest::kernel().connection_manager.get_min_delay();
+  V_.chunk_rows_ =
+    std::max( P_.chunk_rows_, min_delay / V_.interval_steps_ + 1 );
+
+  B_.writer_.reset(); // closes the file of another filename
+  B_.writer_.reset( new AnalogFileWriter(
+    filename.str(), P_.record_from_, targets_, P_.interval_.get_ms() ) );
+
+  start_chunk_(
+    nest::kernel().simulation_manager.get_time().get_steps() - min_delay );
+}
+
+void
+mynest::binary_multimeter::post_run_cleanup()
+{
+  if ( not B_.writer_ )
+  {
+    return;
+  }
+
+  if ( not B_.chunk_.empty() )
+  {
+    B_.writer_->submit( B_.chunk_ );
+  }
+
+  // the samples of the last slice are requested in the next simulation
+  start_chunk_( nest::kernel().simulation_manager.get_time().get_steps()
+    - nest::kernel().connection_manager.get_min_delay() );
+  B_.writer_->flush();
+}
+
+void
+mynest::binary_multimeter::start_chunk_( const long done )
+{
+  const long first =
+    ( std::max( done, 0L ) / V_.interval_steps_ + 1 ) * V_.interval_steps_;
+  B_.chunk_.reset( V_.n_columns_, V_.chunk_rows_, first, V_.interval_steps_ );
+}
+
+/* ----------------------------------------------------------------
+ * Update and event handling functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::binary_multimeter::update( nest::Time const& origin,
+  const long from,
+  const long )
+{
+  // as for the multimeter, the samples of the previous slice are requested
+  // at the beginning of each slice
+  if ( origin.get_steps() == 0 or from != 0 or not B_.writer_ )
+  {
+    return;
+  }
+
+  // the replies hold stamps up to origin
+  if ( B_.chunk_.end_stamp() <= origin.get_steps() )
+  {
+    if ( not B_.chunk_.empty() )
+    {
+      B_.writer_->submit( B_.chunk_ );
+    }
+    start_chunk_( origin.get_steps()
+      - nest::kernel().connection_manager.get_min_delay() );
+  }
+
+  nest::DataLoggingRequest req;
+  nest::kernel().event_delivery_manager.send( *this, req );
+}
+
+void
+mynest::binary_multimeter::handle( nest::DataLoggingReply& reply )
+{
+  const std::unordered_map< nest::index, size_t >::const_iterator column =
+    V_.column_of_.find( reply.get_sender_gid() );
+  if ( column == V_.column_of_.end() )
+  {
+    return;
+  }
+
+  const nest::DataLoggingReply::Container& info = reply.get_info();
+  for ( size_t k = 0; k < info.size() and info[ k ].timestamp.is_finite();
+        ++k )
+  {
+    if ( not device_.is_active( info[ k ].timestamp ) )
+    {
+      continue;
+    }
+
+    const size_t row = B_.chunk_.row_of( info[ k ].timestamp.get_steps() );
+    if ( row == B_.chunk_.n_rows() )
+    {
+      continue; // not on the sampling grid
+    }
+    for ( size_t j = 0; j < info[ k ].data.size(); ++j )
+    {
+      B_.chunk_.set( row, column->second + j, info[ k ].data[ j ] );
+    }
+  }
+}
@@ -0,0 +1,252 @@
+/*
+ *  binary_multimeter.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BINARY_MULTIMETER_H
+#define BINARY_MULTIMETER_H
+
+// C++ includes:
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "event.h"
+#include "exceptions.h"
+#include "nest_time.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+#include "name.h"
+
+// Includes from LIFL_IE:
+#include "analog_file.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: binary_multimeter - Records analog quantities to binary files.
+
+   Description:
+   The binary_multimeter samples recordables of neurons like a multimeter,
+   e.g. V_m, soma_exc and I_syn_ex of lifl_psc_exp_ie or V_m and w of
+   aeif_psc_exp_peak, but writes them to an analog_file instead of
+   keeping them in memory or writing text. The samples are collected in
+   chunks of chunk_rows sampling times, which a background thread writes
+   to the file while the simulation goes on; the simulation waits only if
+   the disk falls behind by more than a chunk. The files stay open across
+   simulations and are flushed when Simulate returns; they are closed when
+   the filename is changed or when the recorder is destroyed, i.e. on
+   ResetKernel or at the end of NEST.
+
+   Each virtual process writes the neurons it owns to its own file,
+   named <filename>-<vp>.dat. The header of the file lists the recordables
+   and the GIDs of the neurons of its columns. The neurons must be
+   connected before the first simulation; record_from and interval can
+   not be changed once neurons are connected.
+
+   As with the multimeter, the samples of the last min_delay of a
+   simulation are only requested from the neurons in the next one, so a
+   file ends min_delay before the current time. The samples of the last
+   min_delay of the final simulation are never written; to record up to
+   time T, simulate until T + min_delay.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   filename     string - Base name of the files
+   record_from  array  - Names of the recordables
+   interval     double - Sampling interval in ms
+   chunk_rows   int    - Sampling times per chunk
+
+   Example:
+   SLI ] /binary_multimeter Create /bm Set
+   SLI ] bm << /filename (vm) /record_from [/V_m /soma_exc]
+               /interval 0.1 >> SetStatus
+   SLI ] bm neuron Connect
+   SLI ] 1000 Simulate
+
+   SeeAlso: analog_file, multimeter
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device sampling recordables of neurons into an analog file.
+ */
+class binary_multimeter : public nest::DeviceNode
+{
+
+public:
+  binary_multimeter();
+  binary_multimeter( const binary_multimeter& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  nest::port send_test_event( nest::Node&, nest::rport, nest::synindex, bool );
+
+  void handle( nest::DataLoggingReply& );
+
+  nest::port handles_test_event( nest::DataLoggingReply&, nest::rport );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+  void post_run_cleanup();
+
+  void update( nest::Time const&, const long, const long );
+
+  //! Begin a new chunk after the samples up to stamp done
+  void start_chunk_( long done );
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    std::string filename_;
+    std::vector< Name > record_from_;
+    nest::Time interval_;
+    long chunk_rows_;
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+
+    //! Set values from dictionary; connected if neurons are connected
+    void set( const DictionaryDatum&, bool connected );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Buffers of the model.
+   */
+  struct Buffers_
+  {
+    std::unique_ptr< AnalogFileWriter > writer_; //!< Open file
+    AnalogChunk chunk_;                          //!< Chunk being filled
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    //! First column of each neuron
+    std::unordered_map< nest::index, size_t > column_of_;
+    size_t n_columns_;
+    size_t chunk_rows_;
+    long interval_steps_;
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  Parameters_ P_;
+  Buffers_ B_;
+  Variables_ V_;
+
+  //! GIDs of the neurons connected to this instance
+  std::vector< long > targets_;
+};
+
+inline nest::port
+binary_multimeter::send_test_event( nest::Node& target,
+  nest::rport receptor_type,
+  nest::synindex,
+  bool )
+{
+  nest::DataLoggingRequest e( P_.interval_, P_.record_from_ );
+  e.set_sender( *this );
+  const nest::port p = target.handles_test_event( e, receptor_type );
+  if ( p != nest::invalid_port_ and not is_model_prototype() )
+  {
+    if ( B_.writer_ )
+    {
+      throw nest::IllegalConnection( "binary_multimeter: neurons must be "
+                                     "connected before the first simulation." );
+    }
+    targets_.push_back( target.get_gid() );
+  }
+  return p;
+}
+
+inline nest::port
+binary_multimeter::handles_test_event( nest::DataLoggingReply&,
+  nest::rport receptor_type )
+{
+  if ( receptor_type != 0 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  return 0;
+}
+
+inline void
+binary_multimeter::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+}
+
+inline void
+binary_multimeter::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_;                 // temporary copy in case of errors
+  ptmp.set( d, not targets_.empty() ); // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+}
+
+} // namespace mynest
+
+#endif // BINARY_MULTIMETER_H
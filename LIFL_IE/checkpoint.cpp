@@ -0,0 +1,337 @@
+/*
+ *  checkpoint.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "checkpoint.h"
+
+// C++ includes:
+#include <cmath>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_time.h"
+
+namespace
+{
+const char checkpoint_magic[ 8 ] = { 'L', 'I', 'F', 'L', 'I', 'E', 'C', 'K' };
+const unsigned int checkpoint_version = 2;
+const unsigned int checkpoint_flag_incremental = 0x1;
+}
+
+std::string
+mynest::CheckpointError::message() const
+{
+  return msg_;
+}
+
+/* ----------------------------------------------------------------
+ * CheckpointBuffer
+ * ---------------------------------------------------------------- */
+
+unsigned long
+mynest::CheckpointBuffer::hash() const
+{
+  unsigned long h = 14695981039346656037UL;
+  for ( size_t i = 0; i < data_.size(); ++i )
+  {
+    h ^= static_cast< unsigned char >( data_[ i ] );
+    h *= 1099511628211UL;
+  }
+  return h;
+}
+
+void
+mynest::CheckpointBuffer::read_( void* dst, size_t n )
+{
+  if ( pos_ + n > data_.size() )
+  {
+    throw CheckpointError( "Checkpoint section is truncated." );
+  }
+  std::memcpy( dst, data_.data() + pos_, n );
+  pos_ += n;
+}
+
+/* ----------------------------------------------------------------
+ * CheckpointState
+ * ---------------------------------------------------------------- */
+
+mynest::CheckpointState::CheckpointState()
+  : buffers_ready_( false )
+  , has_deferred_( false )
+{
+  for ( size_t i = 0; i < CKPT_NUM_SECTIONS; ++i )
+  {
+    hash_[ i ] = 0;
+    valid_[ i ] = false;
+  }
+}
+
+void
+mynest::CheckpointState::defer_buffers( const CheckpointBuffer& b )
+{
+  deferred_ = b.data();
+  has_deferred_ = true;
+}
+
+mynest::CheckpointBuffer
+mynest::CheckpointState::take_deferred_buffers()
+{
+  CheckpointBuffer b( deferred_ );
+  deferred_.clear();
+  has_deferred_ = false;
+  return b;
+}
+
+bool
+mynest::CheckpointState::changed( CheckpointSection id,
+  const CheckpointBuffer& b ) const
+{
+  return not valid_[ id ] or hash_[ id ] != b.hash();
+}
+
+void
+mynest::CheckpointState::mark( CheckpointSection id, const CheckpointBuffer& b )
+{
+  hash_[ id ] = b.hash();
+  valid_[ id ] = true;
+}
+
+/* ----------------------------------------------------------------
+ * CheckpointWriter
+ * ---------------------------------------------------------------- */
+
+mynest::CheckpointWriter::CheckpointWriter( const std::string& filename,
+  bool incremental )
+  : out_( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc )
+  , incremental_( incremental )
+  , gid_( 0 )
+  , num_records_( 0 )
+{
+  if ( not out_.good() )
+  {
+    throw CheckpointError( "Cannot open checkpoint file " + filename
+      + " for writing." );
+  }
+
+  const unsigned int flags = incremental_ ? checkpoint_flag_incremental : 0;
+  const double resolution = nest::Time::get_resolution().get_ms();
+  const double time = nest::kernel().simulation_manager.get_time().get_ms();
+
+  write_( checkpoint_magic, sizeof( checkpoint_magic ) );
+  write_( &checkpoint_version, sizeof( checkpoint_version ) );
+  write_( &flags, sizeof( flags ) );
+  write_( &resolution, sizeof( resolution ) );
+  write_( &time, sizeof( time ) );
+}
+
+mynest::CheckpointWriter::~CheckpointWriter()
+{
+  if ( out_.is_open() )
+  {
+    out_.close();
+  }
+}
+
+void
+mynest::CheckpointWriter::begin_node( nest::index gid,
+  const std::string& family )
+{
+  assert( gid > 0 );
+  gid_ = gid;
+  family_ = family;
+  sections_.clear();
+}
+
+void
+mynest::CheckpointWriter::section( CheckpointSection id,
+  const CheckpointBuffer& b,
+  CheckpointState& state )
+{
+  if ( incremental_ and not state.changed( id, b ) )
+  {
+    return; // unchanged since last checkpoint
+  }
+
+  sections_.push_back(
+    std::make_pair( static_cast< unsigned int >( id ), b.data() ) );
+  state.mark( id, b );
+}
+
+void
+mynest::CheckpointWriter::end_node()
+{
+  if ( sections_.empty() )
+  {
+    return;
+  }
+
+  const unsigned long gid = gid_;
+  const unsigned int family_len = family_.size();
+  const unsigned int n_sections = sections_.size();
+
+  write_( &gid, sizeof( gid ) );
+  write_( &family_len, sizeof( family_len ) );
+  write_( family_.data(), family_len );
+  write_( &n_sections, sizeof( n_sections ) );
+  for ( size_t i = 0; i < sections_.size(); ++i )
+  {
+    const unsigned long len = sections_[ i ].second.size();
+    write_( &sections_[ i ].first, sizeof( unsigned int ) );
+    write_( &len, sizeof( len ) );
+    write_( sections_[ i ].second.data(), len );
+  }
+  sections_.clear();
+  ++num_records_;
+}
+
+void
+mynest::CheckpointWriter::close()
+{
+  const unsigned long terminator = 0;
+  write_( &terminator, sizeof( terminator ) );
+  out_.close();
+}
+
+void
+mynest::CheckpointWriter::write_( const void* src, size_t n )
+{
+  out_.write( reinterpret_cast< const char* >( src ), n );
+  if ( not out_.good() )
+  {
+    throw CheckpointError( "Error writing checkpoint file." );
+  }
+}
+
+/* ----------------------------------------------------------------
+ * CheckpointReader
+ * ---------------------------------------------------------------- */
+
+mynest::CheckpointReader::CheckpointReader( const std::string& filename )
+  : in_( filename.c_str(), std::ios::in | std::ios::binary )
+  , filename_( filename )
+  , incremental_( false )
+  , gid_( 0 )
+{
+  if ( not in_.good() )
+  {
+    throw CheckpointError( "Cannot open checkpoint file " + filename
+      + " for reading." );
+  }
+
+  char magic[ sizeof( checkpoint_magic ) ];
+  unsigned int version;
+  unsigned int flags;
+  double resolution;
+  double time;
+  read_( magic, sizeof( magic ) );
+  read_( &version, sizeof( version ) );
+  if ( std::memcmp( magic, checkpoint_magic, sizeof( magic ) ) != 0
+    or version != checkpoint_version )
+  {
+    throw CheckpointError( filename + " is not a LIFL_IE checkpoint file "
+                                      "of a supported version." );
+  }
+  read_( &flags, sizeof( flags ) );
+  read_( &resolution, sizeof( resolution ) );
+  read_( &time, sizeof( time ) );
+
+  if ( std::abs( resolution - nest::Time::get_resolution().get_ms() ) > 1e-12 )
+  {
+    throw CheckpointError(
+      "Checkpoint was written with a different resolution." );
+  }
+
+  incremental_ = flags & checkpoint_flag_incremental;
+}
+
+bool
+mynest::CheckpointReader::next_node()
+{
+  unsigned long gid;
+  read_( &gid, sizeof( gid ) );
+  if ( gid == 0 )
+  {
+    return false;
+  }
+
+  unsigned int family_len;
+  unsigned int n_sections;
+  read_( &family_len, sizeof( family_len ) );
+  family_.resize( family_len );
+  if ( family_len > 0 )
+  {
+    read_( &family_[ 0 ], family_len );
+  }
+  read_( &n_sections, sizeof( n_sections ) );
+
+  sections_.resize( n_sections );
+  for ( size_t i = 0; i < n_sections; ++i )
+  {
+    unsigned long len;
+    read_( &sections_[ i ].first, sizeof( unsigned int ) );
+    read_( &len, sizeof( len ) );
+    sections_[ i ].second.resize( len );
+    if ( len > 0 )
+    {
+      read_( &sections_[ i ].second[ 0 ], len );
+    }
+  }
+
+  gid_ = gid;
+  return true;
+}
+
+bool
+mynest::CheckpointReader::has_section( CheckpointSection id ) const
+{
+  for ( size_t i = 0; i < sections_.size(); ++i )
+  {
+    if ( sections_[ i ].first == static_cast< unsigned int >( id ) )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+mynest::CheckpointBuffer
+mynest::CheckpointReader::get_section( CheckpointSection id ) const
+{
+  for ( size_t i = 0; i < sections_.size(); ++i )
+  {
+    if ( sections_[ i ].first == static_cast< unsigned int >( id ) )
+    {
+      return CheckpointBuffer( sections_[ i ].second );
+    }
+  }
+  throw CheckpointError( "Checkpoint record has no such section." );
+}
+
+void
+mynest::CheckpointReader::read_( void* dst, size_t n )
+{
+  in_.read( reinterpret_cast< char* >( dst ), n );
+  if ( not in_.good() )
+  {
+    throw CheckpointError( "Checkpoint file " + filename_
+      + " is truncated or unreadable." );
+  }
+}
@@ -0,0 +1,343 @@
+/*
+ *  checkpoint.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// C++ includes:
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "nest_types.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: checkpoint - Binary checkpoint/restore of neuron state.
+
+   Description:
+   lifl_psc_exp_ie and aeif_psc_exp_peak can write their complete dynamic
+   state (membrane and synaptic state, refractoriness, IE plasticity state
+   and the pending contents of their input ring buffers) to a binary file
+   and read it back, so that warm-up phases or long IE training runs need
+   not be repeated.
+
+   The state of each node is split into sections (dynamics, plasticity,
+   buffers). An incremental checkpoint only writes the sections that have
+   changed since the last checkpoint written or restored by the node, and
+   skips unchanged nodes entirely. To restore, load the last full
+   checkpoint followed by the incremental ones in the order they were
+   written.
+
+   Time stamps stored in the state (last modulator spikes, spike history)
+   are written relative to the simulation time at save and restored
+   relative to the simulation time at restore, so a checkpoint can be
+   restored into a freshly built network at time 0. Since the relative
+   stamps change as time advances, an incremental checkpoint rewrites the
+   plasticity section of every node with such stamps. The resolution and
+   the min/max delays must be the same as when the checkpoint was written.
+
+   File layout (all values in native byte order):
+     header : char[8] "LIFLIECK", uint32 version, uint32 flags (bit 0 set
+              for incremental checkpoints), double resolution in ms,
+              double simulation time in ms
+     record : uint64 gid (0 terminates the file), uint32 length + chars of
+              the model family, uint32 number of sections, then per
+              section uint32 section id, uint64 length + payload
+
+   SeeAlso: SaveCheckpoint, RestoreCheckpoint
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Identifiers of the state sections of a checkpoint record.
+ */
+enum CheckpointSection
+{
+  CKPT_DYNAMICS = 0, //!< membrane and synaptic state, refractoriness
+  CKPT_PLASTICITY,   //!< IE plasticity state
+  CKPT_BUFFERS,      //!< pending input in the ring buffers
+  CKPT_NUM_SECTIONS
+};
+
+/**
+ * Exception thrown if a checkpoint cannot be written or read.
+ */
+class CheckpointError : public nest::KernelException
+{
+public:
+  CheckpointError( const std::string& msg )
+    : KernelException( "CheckpointError" )
+    , msg_( msg )
+  {
+  }
+
+  ~CheckpointError() throw()
+  {
+  }
+
+  std::string message() const;
+
+private:
+  std::string msg_;
+};
+
+/**
+ * Byte buffer holding the serialized content of one section.
+ * Values are appended with put() and read back in the same order with get().
+ */
+class CheckpointBuffer
+{
+public:
+  CheckpointBuffer()
+    : pos_( 0 )
+  {
+  }
+
+  explicit CheckpointBuffer( const std::string& data )
+    : data_( data )
+    , pos_( 0 )
+  {
+  }
+
+  template < typename T >
+  void
+  put( const T& v )
+  {
+    data_.append( reinterpret_cast< const char* >( &v ), sizeof( T ) );
+  }
+
+  template < typename T, typename A >
+  void
+  put( const std::vector< T, A >& v )
+  {
+    put< unsigned long >( v.size() );
+    if ( not v.empty() )
+    {
+      data_.append(
+        reinterpret_cast< const char* >( &v[ 0 ] ), v.size() * sizeof( T ) );
+    }
+  }
+
+  template < typename T >
+  void
+  get( T& v )
+  {
+    read_( &v, sizeof( T ) );
+  }
+
+  template < typename T, typename A >
+  void
+  get( std::vector< T, A >& v )
+  {
+    unsigned long n;
+    get( n );
+    v.resize( n );
+    if ( n > 0 )
+    {
+      read_( &v[ 0 ], n * sizeof( T ) );
+    }
+  }
+
+  const std::string&
+  data() const
+  {
+    return data_;
+  }
+
+  //! FNV-1a hash of the content, used to detect changed sections
+  unsigned long hash() const;
+
+private:
+  void read_( void*, size_t );
+
+  std::string data_;
+  size_t pos_;
+};
+
+/**
+ * Per-node checkpoint bookkeeping.
+ * Holds the hashes of the sections last written or restored, and buffer
+ * content restored before the node's buffers were initialized.
+ */
+class CheckpointState
+{
+public:
+  CheckpointState();
+
+  //! True once the node has set up its ring buffers for simulation
+  bool
+  buffers_ready() const
+  {
+    return buffers_ready_;
+  }
+
+  void
+  set_buffers_ready()
+  {
+    buffers_ready_ = true;
+  }
+
+  //! Keep buffer content until the node initializes its buffers
+  void defer_buffers( const CheckpointBuffer& );
+
+  bool
+  has_deferred_buffers() const
+  {
+    return has_deferred_;
+  }
+
+  CheckpointBuffer take_deferred_buffers();
+
+  //! True if the section differs from the one last saved or restored
+  bool changed( CheckpointSection, const CheckpointBuffer& ) const;
+
+  //! Remember the section content as the one last saved or restored
+  void mark( CheckpointSection, const CheckpointBuffer& );
+
+private:
+  unsigned long hash_[ CKPT_NUM_SECTIONS ];
+  bool valid_[ CKPT_NUM_SECTIONS ];
+  bool buffers_ready_;
+  bool has_deferred_;
+  std::string deferred_;
+};
+
+/**
+ * Writes checkpoint records to a file.
+ */
+class CheckpointWriter
+{
+public:
+  CheckpointWriter( const std::string& filename, bool incremental );
+  ~CheckpointWriter();
+
+  bool
+  incremental() const
+  {
+    return incremental_;
+  }
+
+  //! Start the record of a node
+  void begin_node( nest::index gid, const std::string& family );
+
+  /**
+   * Add a section to the current record.
+   * For incremental checkpoints, the section is dropped if it has not
+   * changed since the node's last checkpoint.
+   */
+  void section( CheckpointSection, const CheckpointBuffer&, CheckpointState& );
+
+  //! Finish the record; records without sections are not written
+  void end_node();
+
+  //! Write terminator and close file
+  void close();
+
+  //! Number of node records written
+  size_t
+  num_records() const
+  {
+    return num_records_;
+  }
+
+private:
+  void write_( const void*, size_t );
+
+  std::ofstream out_;
+  bool incremental_;
+  nest::index gid_;
+  std::string family_;
+  std::vector< std::pair< unsigned int, std::string > > sections_;
+  size_t num_records_;
+};
+
+/**
+ * Reads checkpoint records from a file.
+ */
+class CheckpointReader
+{
+public:
+  explicit CheckpointReader( const std::string& filename );
+
+  //! Advance to the next record, returns false at the end of the file
+  bool next_node();
+
+  nest::index
+  gid() const
+  {
+    return gid_;
+  }
+
+  const std::string&
+  family() const
+  {
+    return family_;
+  }
+
+  bool has_section( CheckpointSection ) const;
+
+  //! Content of a section of the current record
+  CheckpointBuffer get_section( CheckpointSection ) const;
+
+  bool
+  incremental() const
+  {
+    return incremental_;
+  }
+
+private:
+  void read_( void*, size_t );
+
+  std::ifstream in_;
+  std::string filename_;
+  bool incremental_;
+  nest::index gid_;
+  std::string family_;
+  std::vector< std::pair< unsigned int, std::string > > sections_;
+};
+
+/**
+ * Interface implemented by models that support checkpointing.
+ */
+class Checkpointable
+{
+public:
+  virtual ~Checkpointable()
+  {
+  }
+
+  //! Write the record of this node
+  virtual void save_checkpoint( CheckpointWriter& ) = 0;
+
+  //! Apply the current record of the reader to this node
+  virtual void restore_checkpoint( const CheckpointReader& ) = 0;
+};
+
+} // namespace mynest
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,79 @@
+/*
+ *  checkpoint_ring_buffer.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "checkpoint_ring_buffer.h"
+
+// C++ includes:
+#include <algorithm>
+
+mynest::CheckpointRingBuffer::CheckpointRingBuffer()
+  : buffer_( nest::kernel().connection_manager.get_min_delay()
+        + nest::kernel().connection_manager.get_max_delay(),
+      0.0 )
+{
+}
+
+void
+mynest::CheckpointRingBuffer::resize()
+{
+  const size_t size = nest::kernel().connection_manager.get_min_delay()
+    + nest::kernel().connection_manager.get_max_delay();
+  if ( buffer_.size() != size )
+  {
+    buffer_.resize( size );
+  }
+}
+
+void
+mynest::CheckpointRingBuffer::clear()
+{
+  resize();                                         // does nothing if size is fine
+  std::fill( buffer_.begin(), buffer_.end(), 0.0 ); // clear all elements
+}
+
+void
+mynest::CheckpointRingBuffer::save( CheckpointBuffer& b ) const
+{
+  std::vector< double > pending( buffer_.size() );
+  for ( size_t d = 0; d < buffer_.size(); ++d )
+  {
+    pending[ d ] = buffer_[ get_index_( d ) ];
+  }
+  b.put( pending );
+}
+
+void
+mynest::CheckpointRingBuffer::restore( CheckpointBuffer& b )
+{
+  std::vector< double > pending;
+  b.get( pending );
+  resize();
+  if ( pending.size() != buffer_.size() )
+  {
+    throw CheckpointError(
+      "Checkpoint was written with different min/max delays." );
+  }
+  for ( size_t d = 0; d < buffer_.size(); ++d )
+  {
+    buffer_[ get_index_( d ) ] = pending[ d ];
+  }
+}
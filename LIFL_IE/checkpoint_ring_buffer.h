@@ -0,0 +1,146 @@
+/*
+ *  checkpoint_ring_buffer.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CHECKPOINT_RING_BUFFER_H
+#define CHECKPOINT_RING_BUFFER_H
+
+// C++ includes:
+#include <vector>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_types.h"
+
+// Includes from LIFL_IE:
+#include "checkpoint.h"
+
+namespace mynest
+{
+
+/**
+ * Ring buffer for incoming spikes and currents, equivalent to
+ * nest::RingBuffer, whose pending content can be written to and restored
+ * from a checkpoint.
+ *
+ * The content is serialized in order of increasing delay relative to the
+ * current slice origin, so it can be restored at any other point in time.
+ */
+class CheckpointRingBuffer
+{
+public:
+  CheckpointRingBuffer();
+
+  /**
+   * Add a value to the ring buffer.
+   * @param  offs     Arrival time relative to beginning of slice.
+   * @param  double Value to add.
+   */
+  void add_value( const long offs, const double );
+
+  /**
+   * Set a ring buffer entry to a given value.
+   * @param  offs     Arrival time relative to beginning of slice.
+   * @param  double Value to set.
+   */
+  void set_value( const long offs, const double );
+
+  /**
+   * Read one value from ring buffer and reset the entry to zero.
+   * @param  offs  Offset of element to read within slice.
+   * @returns value
+   */
+  double get_value( const long offs );
+
+  /**
+   * Initialize the buffer with noughts.
+   * Also resizes the buffer if necessary.
+   */
+  void clear();
+
+  /**
+   * Resize the buffer according to max_thread and max_delay.
+   */
+  void resize();
+
+  size_t
+  size() const
+  {
+    return buffer_.size();
+  }
+
+  //! Append the pending content to a checkpoint section
+  void save( CheckpointBuffer& ) const;
+
+  //! Replace the content by the one stored in a checkpoint section
+  void restore( CheckpointBuffer& );
+
+private:
+  //! Buffered data
+  std::vector< double > buffer_;
+
+  /**
+   * Obtain buffer index.
+   * @param delay delivery delay for event
+   * @returns index to buffer element into which event should be
+   * recorded.
+   */
+  size_t get_index_( const nest::delay d ) const;
+};
+
+inline void
+CheckpointRingBuffer::add_value( const long offs, const double v )
+{
+  buffer_[ get_index_( offs ) ] += v;
+}
+
+inline void
+CheckpointRingBuffer::set_value( const long offs, const double v )
+{
+  buffer_[ get_index_( offs ) ] = v;
+}
+
+inline double
+CheckpointRingBuffer::get_value( const long offs )
+{
+  assert( 0 <= offs and ( size_t ) offs < buffer_.size() );
+  assert( ( nest::delay ) offs
+    < nest::kernel().connection_manager.get_min_delay() );
+
+  // offs == 0 is beginning of slice, but we have to
+  // take modulo into account when indexing
+  const size_t idx = get_index_( offs );
+  const double val = buffer_[ idx ];
+  buffer_[ idx ] = 0.0; // clear buffer after reading
+  return val;
+}
+
+inline size_t
+CheckpointRingBuffer::get_index_( const nest::delay d ) const
+{
+  const long idx = nest::kernel().event_delivery_manager.get_modulo( d );
+  assert( ( size_t ) idx < buffer_.size() );
+  return idx;
+}
+
+} // namespace mynest
+
+#endif // CHECKPOINT_RING_BUFFER_H
@@ -0,0 +1,257 @@
+/*
+ *  column_builder.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "column_builder.h"
+
+// C++ includes:
+#include <utility>
+#include <vector>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "gid_collection.h"
+#include "kernel_manager.h"
+#include "nest.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dictutils.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+#include "stimulator_grid.h"
+
+mynest::ColumnBuilder::ColumnBuilder( const DictionaryDatum& spec )
+  : spec_( spec )
+{
+  if ( spec_->known( names::inputs ) )
+  {
+    const DictionaryDatum inputs =
+      getValue< DictionaryDatum >( spec_, names::inputs );
+    for ( Dictionary::const_iterator it = inputs->begin(); it != inputs->end();
+          ++it )
+    {
+      inputs_[ it->first.toString() ] = getValue< TokenArray >( it->second );
+    }
+  }
+}
+
+DictionaryDatum
+mynest::ColumnBuilder::build()
+{
+  const TokenArray pops = getValue< TokenArray >( spec_, names::populations );
+  for ( size_t k = 0; k < pops.size(); ++k )
+  {
+    create_population_( getValue< DictionaryDatum >( pops[ k ] ) );
+  }
+
+  if ( spec_->known( names::projections ) )
+  {
+    const TokenArray projs =
+      getValue< TokenArray >( spec_, names::projections );
+    for ( size_t k = 0; k < projs.size(); ++k )
+    {
+      connect_projection_( getValue< DictionaryDatum >( projs[ k ] ) );
+    }
+  }
+
+  if ( spec_->known( names::ie_grid ) )
+  {
+    connect_ie_grid_( getValue< DictionaryDatum >( spec_, names::ie_grid ) );
+  }
+
+  DictionaryDatum result( new Dictionary );
+  for ( std::map< std::string, TokenArray >::const_iterator it =
+          populations_.begin();
+        it != populations_.end();
+        ++it )
+  {
+    ( *result )[ it->first ] = ArrayDatum( it->second );
+  }
+  return result;
+}
+
+void
+mynest::ColumnBuilder::create_population_( const DictionaryDatum& pop )
+{
+  const std::string name = getValue< std::string >( pop, names::name );
+  const Name model = getValue< std::string >( pop, nest::names::model );
+  const long n = getValue< long >( pop, nest::names::n );
+  if ( n <= 0 )
+  {
+    throw nest::BadProperty( "Population " + name + " must not be empty." );
+  }
+  if ( populations_.count( name ) or inputs_.count( name ) )
+  {
+    throw nest::BadProperty( "Population " + name + " is defined twice." );
+  }
+
+  // create from modified model defaults, so that the neurons share the
+  // parameters; only the modified defaults are restored afterwards
+  nest::index last;
+  if ( pop->known( names::params ) )
+  {
+    const DictionaryDatum params =
+      getValue< DictionaryDatum >( pop, names::params );
+    const DictionaryDatum defaults = nest::get_model_defaults( model );
+    DictionaryDatum previous( new Dictionary );
+    for ( Dictionary::const_iterator it = params->begin(); it != params->end();
+          ++it )
+    {
+      // write-only entries have no default to restore
+      if ( defaults->known( it->first ) )
+      {
+        ( *previous )[ it->first ] = ( *defaults )[ it->first ];
+      }
+    }
+
+    nest::set_model_defaults( model, params );
+    try
+    {
+      last = nest::create( model, n );
+    }
+    catch ( ... )
+    {
+      nest::set_model_defaults( model, previous );
+      throw;
+    }
+    nest::set_model_defaults( model, previous );
+  }
+  else
+  {
+    last = nest::create( model, n );
+  }
+  const nest::index first = last - n + 1;
+
+  TokenArray& gids = populations_[ name ];
+  gids.reserve( n );
+  for ( nest::index gid = first; gid <= last; ++gid )
+  {
+    gids.push_back( static_cast< long >( gid ) );
+  }
+
+  // individual initial values
+  std::vector< double > V_m_range;
+  const bool random_V_m =
+    updateValue< std::vector< double > >( pop, names::V_m_range, V_m_range );
+  if ( random_V_m
+    and ( V_m_range.size() != 2 or V_m_range[ 1 ] < V_m_range[ 0 ] ) )
+  {
+    throw nest::BadProperty(
+      "V_m_range must be [low, high] with low <= high." );
+  }
+
+  std::vector< std::pair< Name, TokenArray > > per_node;
+  if ( pop->known( names::per_node ) )
+  {
+    const DictionaryDatum entries =
+      getValue< DictionaryDatum >( pop, names::per_node );
+    for ( Dictionary::const_iterator it = entries->begin();
+          it != entries->end();
+          ++it )
+    {
+      per_node.push_back(
+        std::make_pair( it->first, getValue< TokenArray >( it->second ) ) );
+      if ( per_node.back().second.size() != static_cast< size_t >( n ) )
+      {
+        throw nest::BadProperty( "per_node entry " + it->first.toString()
+          + " of population " + name + " must have one value per neuron." );
+      }
+    }
+  }
+
+  if ( not random_V_m and per_node.empty() )
+  {
+    return;
+  }
+
+  // one dictionary for all neurons; each entry is overwritten per neuron
+  librandom::RngPtr rng = nest::kernel().rng_manager.get_grng();
+  DictionaryDatum d( new Dictionary );
+  for ( long k = 0; k < n; ++k )
+  {
+    if ( random_V_m )
+    {
+      ( *d )[ nest::names::V_m ] =
+        V_m_range[ 0 ] + ( V_m_range[ 1 ] - V_m_range[ 0 ] ) * rng->drand();
+    }
+    for ( size_t j = 0; j < per_node.size(); ++j )
+    {
+      ( *d )[ per_node[ j ].first ] = per_node[ j ].second[ k ];
+    }
+    nest::set_node_status( first + k, d );
+  }
+}
+
+void
+mynest::ColumnBuilder::connect_projection_( const DictionaryDatum& proj )
+{
+  const TokenArray& sources =
+    population_( getValue< std::string >( proj, names::source ) );
+  const TokenArray& targets =
+    population_( getValue< std::string >( proj, names::target ) );
+  const DictionaryDatum conn_spec =
+    getValue< DictionaryDatum >( proj, names::conn_spec );
+  const DictionaryDatum syn_spec = proj->known( names::syn_spec )
+    ? getValue< DictionaryDatum >( proj, names::syn_spec )
+    : DictionaryDatum( new Dictionary );
+
+  nest::connect( nest::GIDCollection( sources ),
+    nest::GIDCollection( targets ),
+    conn_spec,
+    syn_spec );
+}
+
+void
+mynest::ColumnBuilder::connect_ie_grid_( const DictionaryDatum& grid_spec )
+{
+  const TokenArray& pop =
+    population_( getValue< std::string >( grid_spec, names::population ) );
+
+  std::vector< nest::index > gids;
+  gids.reserve( pop.size() );
+  for ( size_t k = 0; k < pop.size(); ++k )
+  {
+    gids.push_back( getValue< long >( pop[ k ] ) );
+  }
+
+  StimulatorGrid grid( gids, grid_spec );
+  grid.connect();
+}
+
+const TokenArray&
+mynest::ColumnBuilder::population_( const std::string& name ) const
+{
+  std::map< std::string, TokenArray >::const_iterator it =
+    populations_.find( name );
+  if ( it != populations_.end() )
+  {
+    return it->second;
+  }
+  it = inputs_.find( name );
+  if ( it != inputs_.end() )
+  {
+    return it->second;
+  }
+  throw nest::BadProperty( "Unknown population " + name + "." );
+}
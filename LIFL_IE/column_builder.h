@@ -0,0 +1,113 @@
+/*
+ *  column_builder.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLUMN_BUILDER_H
+#define COLUMN_BUILDER_H
+
+// C++ includes:
+#include <map>
+#include <string>
+
+// Includes from sli:
+#include "dictdatum.h"
+#include "tokenarray.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: column_builder - Build a network of populations from a spec.
+
+   Description:
+   BuildColumn creates a network such as the V1 oriented column, described
+   by a single specification dictionary, in one call: the populations
+   with their parameters and randomised initial membrane potentials, the
+   projections between them and the IE modulator grid of the detector
+   population. All populations of a model share the parameters given for
+   it, as they are created from temporarily modified model defaults.
+
+   The specification dictionary contains:
+     inputs       dictionary - Existing populations that projections may
+                               use, mapping names to GID arrays (optional)
+     populations  array      - One dictionary per population, see below
+     projections  array      - One dictionary per projection, see below
+                               (optional)
+     ie_grid      dictionary - Spec of ConnectStimulatorGrid with an
+                               additional entry population naming the
+                               detector population (optional)
+
+   A population dictionary contains:
+     name         string     - Name of the population
+     model        string     - Neuron model
+     n            int        - Number of neurons
+     params       dictionary - Parameters common to all neurons (optional)
+     V_m_range    double array - [low, high]: initial V_m drawn uniformly
+                               per neuron (optional)
+     per_node     dictionary - Arrays of one value per neuron, e.g. the
+                               trained soma_exc values of an IE bank
+                               (optional)
+
+   A projection dictionary contains:
+     source, target  string     - Names of populations or inputs
+     conn_spec       dictionary - Connection rule, as for Connect
+     syn_spec        dictionary - Synapse specification, as for Connect
+                                  (optional)
+
+   BuildColumn returns a dictionary mapping the population names to arrays
+   of their GIDs. The random initial potentials are drawn from the global
+   random number generator, so the network does not depend on the number
+   of threads.
+
+   SeeAlso: BuildColumn, ConnectStimulatorGrid, stimulator_grid
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Network of populations and projections described by a spec dictionary.
+ */
+class ColumnBuilder
+{
+public:
+  explicit ColumnBuilder( const DictionaryDatum& spec );
+
+  /**
+   * Create and connect the network.
+   * @returns dictionary of the GIDs of each created population
+   */
+  DictionaryDatum build();
+
+private:
+  void create_population_( const DictionaryDatum& );
+  void connect_projection_( const DictionaryDatum& );
+  void connect_ie_grid_( const DictionaryDatum& );
+
+  //! GIDs of a population or input by name
+  const TokenArray& population_( const std::string& ) const;
+
+  DictionaryDatum spec_;
+  std::map< std::string, TokenArray > inputs_;
+  std::map< std::string, TokenArray > populations_;
+};
+
+} // namespace mynest
+
+#endif // COLUMN_BUILDER_H
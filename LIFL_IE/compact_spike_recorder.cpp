@@ -0,0 +1,243 @@
+/*
+ *  compact_spike_recorder.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "compact_spike_recorder.h"
+
+// C++ includes:
+#include <algorithm>
+#include <sstream>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_names.h"
+#include "nest_time.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "integerdatum.h"
+#include "stringdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters
+ * ---------------------------------------------------------------- */
+
+mynest::compact_spike_recorder::Parameters_::Parameters_()
+  : filename_( "compact_spike_recorder" )
+  , block_spikes_( 4096 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::compact_spike_recorder::Parameters_::get( DictionaryDatum& d ) const
+{
+  ( *d )[ names::filename ] = filename_;
+  def< long >( d, names::block_spikes, block_spikes_ );
+}
+
+void
+mynest::compact_spike_recorder::Parameters_::set( const DictionaryDatum& d )
+{
+  updateValue< std::string >( d, names::filename, filename_ );
+  updateValue< long >( d, names::block_spikes, block_spikes_ );
+  if ( filename_.empty() )
+  {
+    throw nest::BadProperty( "filename must not be empty." );
+  }
+  if ( block_spikes_ < 1 )
+  {
+    throw nest::BadProperty( "block_spikes must be positive." );
+  }
+}
+
+void
+mynest::compact_spike_recorder::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+
+  long n_events = 0;
+  updateValue< long >( d, nest::names::n_events, n_events );
+  n_events += B_.received_.size() + B_.block_.size();
+  if ( B_.writer_ )
+  {
+    n_events += B_.writer_->n_spikes();
+  }
+  def< long >( d, nest::names::n_events, n_events );
+
+  // the instance on thread 0 also counts the spikes of the other threads
+  if ( get_thread() == 0 )
+  {
+    const nest::SiblingContainer* siblings =
+      nest::kernel().node_manager.get_thread_siblings( get_gid() );
+    std::vector< nest::Node* >::const_iterator sibling;
+    for ( sibling = siblings->begin() + 1; sibling != siblings->end();
+          ++sibling )
+    {
+      ( *sibling )->get_status( d );
+    }
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::compact_spike_recorder::compact_spike_recorder()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , B_()
+{
+}
+
+mynest::compact_spike_recorder::compact_spike_recorder(
+  const compact_spike_recorder& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , B_()
+{
+}
+
+mynest::compact_spike_recorder::~compact_spike_recorder()
+{
+  if ( B_.writer_ )
+  {
+    collect_( 1 ); // the index is written when the writer is destroyed
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::compact_spike_recorder::init_state_( const Node& proto )
+{
+  const compact_spike_recorder& pr =
+    downcast< compact_spike_recorder >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::compact_spike_recorder::init_buffers_()
+{
+  device_.init_buffers();
+  B_.received_.clear();
+  B_.block_.clear();
+}
+
+void
+mynest::compact_spike_recorder::calibrate()
+{
+  device_.calibrate();
+
+  std::ostringstream filename;
+  filename << P_.filename_ << "-" << get_vp() << ".spks";
+  if ( B_.writer_ and B_.writer_->filename() == filename.str() )
+  {
+    return; // continue the file of the previous simulation
+  }
+
+  // the spikes still collected belong to the previous file
+  collect_( 1 );
+  B_.writer_.reset();
+  B_.writer_.reset( new SpikeStreamWriter(
+    filename.str(), nest::Time::get_resolution().get_ms() ) );
+}
+
+void
+mynest::compact_spike_recorder::post_run_cleanup()
+{
+  if ( B_.writer_ )
+  {
+    collect_( 1 );
+    B_.writer_->flush();
+  }
+}
+
+void
+mynest::compact_spike_recorder::finalize()
+{
+  // finalize() ends every simulation, the file is completed in the
+  // destructor or when the filename changes
+  if ( B_.writer_ )
+  {
+    collect_( 1 );
+    B_.writer_->flush();
+  }
+}
+
+void
+mynest::compact_spike_recorder::collect_( const size_t min_spikes )
+{
+  // the spikes of one slice arrive in the order of delivery, and all of
+  // them arrive before the slice after it is updated
+  std::sort( B_.received_.begin(), B_.received_.end() );
+  B_.block_.insert(
+    B_.block_.end(), B_.received_.begin(), B_.received_.end() );
+  B_.received_.clear();
+
+  if ( B_.writer_ and not B_.block_.empty()
+    and B_.block_.size() >= min_spikes )
+  {
+    B_.writer_->write_block( B_.block_, 0, B_.block_.size() );
+    B_.block_.clear();
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and event handling functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::compact_spike_recorder::update( nest::Time const&,
+  const long,
+  const long )
+{
+  collect_( P_.block_spikes_ );
+}
+
+void
+mynest::compact_spike_recorder::handle( nest::SpikeEvent& e )
+{
+  if ( not device_.is_active( e.get_stamp() ) )
+  {
+    return;
+  }
+
+  const SpikeStreamWriter::Spike spike(
+    e.get_stamp().get_steps(), e.get_sender_gid() );
+  for ( int i = 0; i < e.get_multiplicity(); ++i )
+  {
+    B_.received_.push_back( spike );
+  }
+}
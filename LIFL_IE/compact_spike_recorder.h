@@ -0,0 +1,210 @@
+/*
+ *  compact_spike_recorder.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMPACT_SPIKE_RECORDER_H
+#define COMPACT_SPIKE_RECORDER_H
+
+// C++ includes:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "event.h"
+#include "exceptions.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+// Includes from LIFL_IE:
+#include "spike_stream.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: compact_spike_recorder - Records spikes to compact binary files.
+
+   Description:
+   The compact_spike_recorder records the spikes of the neurons connected
+   to it like a spike_detector, but writes them to a spike_stream instead
+   of keeping them in memory: the spikes are delta-encoded in blocks of
+   about block_spikes spikes, with an index that allows to read the
+   spikes of a time window alone. The spikes of long simulations thus
+   need neither memory nor the transfer of the complete event arrays to
+   Python; read_spike_stream in Examples/lifl_ie_io.py reads the spikes
+   of a time window into numpy arrays.
+
+   Each virtual process writes the spikes of the neurons it owns to its
+   own file, named <filename>-<vp>.spks. A block ends at the end of a
+   time slice, so the blocks of a virtual process do not overlap in
+   time. All blocks are written when Simulate returns, except for the
+   spikes of the last time slice, which are delivered in the next
+   simulation as for the spike_detector. The file stays open across
+   simulations and is flushed at the end of each one; it is completed
+   with its index when the filename is changed or when the recorder is
+   destroyed, i.e. on ResetKernel or at the end of NEST. Until then,
+   read_spike_stream reads it without the index.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   filename      string - Base name of the files
+   block_spikes  int    - Number of spikes from which a block is written
+
+   The following parameter can be read out:
+
+   n_events      int    - Number of spikes recorded
+
+   Example:
+   SLI ] /compact_spike_recorder Create /sr Set
+   SLI ] sr << /filename (spikes) >> SetStatus
+   SLI ] neurons sr Connect
+   SLI ] 3600000 Simulate
+
+   Receives: SpikeEvent
+
+   SeeAlso: spike_stream, spike_detector
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device writing the spikes it receives to a spike stream.
+ */
+class compact_spike_recorder : public nest::DeviceNode
+{
+
+public:
+  compact_spike_recorder();
+  compact_spike_recorder( const compact_spike_recorder& );
+  ~compact_spike_recorder();
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  //! Spikes are recorded on the thread of their sender
+  bool
+  local_receiver() const
+  {
+    return true;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  void handle( nest::SpikeEvent& );
+
+  nest::port handles_test_event( nest::SpikeEvent&, nest::rport );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  void finalize();
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+  void post_run_cleanup();
+
+  void update( nest::Time const&, const long, const long );
+
+  //! Move the spikes received to the block, write it if full enough
+  void collect_( size_t min_spikes );
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    std::string filename_;
+    long block_spikes_;
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+    void set( const DictionaryDatum& ); //!< Set values from dictionary
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Buffers of the model.
+   */
+  struct Buffers_
+  {
+    std::unique_ptr< SpikeStreamWriter > writer_; //!< Open file
+    //! Spikes received since the last update, in delivery order
+    std::vector< SpikeStreamWriter::Spike > received_;
+    //! Spikes of the block being collected, sorted by step
+    std::vector< SpikeStreamWriter::Spike > block_;
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  Parameters_ P_;
+  Buffers_ B_;
+};
+
+inline nest::port
+compact_spike_recorder::handles_test_event( nest::SpikeEvent&,
+  nest::rport receptor_type )
+{
+  if ( receptor_type != 0 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  return 0;
+}
+
+inline void
+compact_spike_recorder::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_; // temporary copy in case of errors
+  ptmp.set( d );         // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+}
+
+} // namespace mynest
+
+#endif // COMPACT_SPIKE_RECORDER_H
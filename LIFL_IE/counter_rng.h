@@ -0,0 +1,166 @@
+/*
+ *  counter_rng.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+// C++ includes:
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// Includes from libnestutil:
+#include "numerics.h"
+
+namespace mynest
+{
+
+/**
+ * Counter-based random number generator (Philox4x32-10, Salmon et al.,
+ * SC'11).
+ *
+ * The random numbers are a pure function of the key (seed), a stream
+ * number and a counter, and the generator has no state. Each channel of a
+ * device can therefore draw the numbers of any time step on any thread,
+ * in any order, and gets the same values independently of the number of
+ * threads and of the other channels.
+ */
+class CounterRNG
+{
+public:
+  typedef std::array< std::uint32_t, 4 > Block;
+
+  explicit CounterRNG( unsigned long seed = 0 )
+    : key0_( static_cast< std::uint32_t >( seed ) )
+    , key1_( static_cast< std::uint32_t >( seed >> 32 ) )
+  {
+  }
+
+  /**
+   * Key made from seed and an identifier, e.g. the GID of a device, so
+   * that devices with the same seed draw different numbers.
+   */
+  CounterRNG( std::uint64_t seed, std::uint64_t id )
+    : CounterRNG( seed + std::uint64_t( 0x9E3779B97F4A7C15 ) * id )
+  {
+  }
+
+  /**
+   * Four random 32-bit words for counter, stream and tag. The tag
+   * separates independent uses of the same stream and counter.
+   */
+  Block
+  block( unsigned long counter,
+    std::uint32_t stream,
+    std::uint32_t tag = 0 ) const
+  {
+    Block c = { { static_cast< std::uint32_t >( counter ),
+      static_cast< std::uint32_t >( counter >> 32 ),
+      stream,
+      tag } };
+    std::uint32_t k0 = key0_;
+    std::uint32_t k1 = key1_;
+    for ( int r = 0; r < 10; ++r )
+    {
+      const std::uint64_t p0 = std::uint64_t( 0xD2511F53 ) * c[ 0 ];
+      const std::uint64_t p1 = std::uint64_t( 0xCD9E8D57 ) * c[ 2 ];
+      c = { { static_cast< std::uint32_t >( p1 >> 32 ) ^ c[ 1 ] ^ k0,
+        static_cast< std::uint32_t >( p1 ),
+        static_cast< std::uint32_t >( p0 >> 32 ) ^ c[ 3 ] ^ k1,
+        static_cast< std::uint32_t >( p0 ) } };
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+    return c;
+  }
+
+  //! Uniform number in (0, 1)
+  double
+  uniform( unsigned long counter,
+    std::uint32_t stream,
+    std::uint32_t tag = 0 ) const
+  {
+    return to_uniform_( block( counter, stream, tag )[ 0 ] );
+  }
+
+  //! Standard normal number (Box-Muller)
+  double
+  normal( unsigned long counter,
+    std::uint32_t stream,
+    std::uint32_t tag = 0 ) const
+  {
+    return to_normal_( block( counter, stream, tag ) );
+  }
+
+  /**
+   * Poisson number with mean lambda. Small means, such as spike counts per
+   * time step, are drawn exactly by inversion from a single uniform number;
+   * above 30 the normal approximation is used.
+   */
+  long
+  poisson( double lambda,
+    unsigned long counter,
+    std::uint32_t stream,
+    std::uint32_t tag = 0 ) const
+  {
+    const Block b = block( counter, stream, tag );
+    if ( lambda > 30.0 )
+    {
+      const double n =
+        std::floor( lambda + std::sqrt( lambda ) * to_normal_( b ) + 0.5 );
+      return n > 0 ? static_cast< long >( n ) : 0;
+    }
+
+    const double u = to_uniform_( b[ 0 ] );
+    double p = std::exp( -lambda );
+    double cdf = p;
+    long n = 0;
+    while ( u > cdf and p > 0 )
+    {
+      ++n;
+      p *= lambda / n;
+      cdf += p;
+    }
+    return n;
+  }
+
+private:
+  static double
+  to_uniform_( std::uint32_t x )
+  {
+    return ( x + 0.5 ) * ( 1.0 / 4294967296.0 );
+  }
+
+  static double
+  to_normal_( const Block& b )
+  {
+    return std::sqrt( -2.0 * std::log( to_uniform_( b[ 0 ] ) ) )
+      * std::cos( 2.0 * numerics::pi * to_uniform_( b[ 1 ] ) );
+  }
+
+  std::uint32_t key0_;
+  std::uint32_t key1_;
+};
+
+} // namespace mynest
+
+#endif // COUNTER_RNG_H
@@ -0,0 +1,179 @@
+/*
+ *  cursor_spike_recorder.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cursor_spike_recorder.h"
+
+// C++ includes:
+#include <algorithm>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_names.h"
+#include "nest_time.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dict.h"
+#include "dictutils.h"
+#include "integerdatum.h"
+
+void
+mynest::cursor_spike_recorder::get_status( DictionaryDatum& d ) const
+{
+  device_.get_status( d );
+
+  long n_events = 0;
+  updateValue< long >( d, nest::names::n_events, n_events );
+  def< long >( d, nest::names::n_events, n_events + spikes_.size() );
+
+  // the instance on thread 0 also counts the spikes of the other threads
+  if ( get_thread() == 0 )
+  {
+    const nest::SiblingContainer* siblings =
+      nest::kernel().node_manager.get_thread_siblings( get_gid() );
+    std::vector< nest::Node* >::const_iterator sibling;
+    for ( sibling = siblings->begin() + 1; sibling != siblings->end();
+          ++sibling )
+    {
+      ( *sibling )->get_status( d );
+    }
+  }
+}
+
+void
+mynest::cursor_spike_recorder::set_status( const DictionaryDatum& d )
+{
+  long n_events;
+  const bool clear = updateValue< long >( d, nest::names::n_events, n_events );
+  if ( clear and n_events != 0 )
+  {
+    throw nest::BadProperty( "n_events can only be set to 0." );
+  }
+
+  device_.set_status( d );
+
+  if ( clear )
+  {
+    spikes_.clear();
+  }
+}
+
+DictionaryDatum
+mynest::cursor_spike_recorder::fetch()
+{
+  std::vector< Spike_ > spikes;
+  const nest::SiblingContainer* siblings =
+    nest::kernel().node_manager.get_thread_siblings( get_gid() );
+  std::vector< nest::Node* >::const_iterator sibling;
+  for ( sibling = siblings->begin(); sibling != siblings->end(); ++sibling )
+  {
+    cursor_spike_recorder* r =
+      static_cast< cursor_spike_recorder* >( *sibling );
+    spikes.insert( spikes.end(), r->spikes_.begin(), r->spikes_.end() );
+    r->spikes_.clear();
+  }
+  std::sort( spikes.begin(), spikes.end() );
+
+  std::vector< long >* senders = new std::vector< long >( spikes.size() );
+  std::vector< double >* times = new std::vector< double >( spikes.size() );
+  for ( size_t k = 0; k < spikes.size(); ++k )
+  {
+    ( *senders )[ k ] = spikes[ k ].second;
+    ( *times )[ k ] =
+      nest::Time( nest::Time::step( spikes[ k ].first ) ).get_ms();
+  }
+
+  DictionaryDatum d( new Dictionary );
+  ( *d )[ nest::names::senders ] = IntVectorDatum( senders );
+  ( *d )[ nest::names::times ] = DoubleVectorDatum( times );
+  return d;
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::cursor_spike_recorder::cursor_spike_recorder()
+  : DeviceNode()
+  , device_()
+  , spikes_()
+{
+}
+
+mynest::cursor_spike_recorder::cursor_spike_recorder(
+  const cursor_spike_recorder& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , spikes_()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::cursor_spike_recorder::init_state_( const Node& proto )
+{
+  const cursor_spike_recorder& pr = downcast< cursor_spike_recorder >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::cursor_spike_recorder::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::cursor_spike_recorder::calibrate()
+{
+  device_.calibrate();
+}
+
+/* ----------------------------------------------------------------
+ * Update and event handling functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::cursor_spike_recorder::update( nest::Time const&,
+  const long,
+  const long )
+{
+  // the spikes are kept as they arrive, see handle
+}
+
+void
+mynest::cursor_spike_recorder::handle( nest::SpikeEvent& e )
+{
+  if ( not device_.is_active( e.get_stamp() ) )
+  {
+    return;
+  }
+
+  const Spike_ spike( e.get_stamp().get_steps(), e.get_sender_gid() );
+  for ( int i = 0; i < e.get_multiplicity(); ++i )
+  {
+    spikes_.push_back( spike );
+  }
+}
@@ -0,0 +1,153 @@
+/*
+ *  cursor_spike_recorder.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CURSOR_SPIKE_RECORDER_H
+#define CURSOR_SPIKE_RECORDER_H
+
+// C++ includes:
+#include <utility>
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "event.h"
+#include "exceptions.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: cursor_spike_recorder - Records spikes to be fetched incrementally.
+
+   Description:
+   The cursor_spike_recorder records the spikes of the neurons connected
+   to it like a spike_detector, but hands them out only once: FetchSpikes
+   returns the spikes recorded since the previous FetchSpikes and drops
+   them from the recorder. Analysing a long simulation trial by trial
+   thus costs the same for each trial, while reading the events of a
+   spike_detector after each trial copies the whole history recorded so
+   far every time.
+
+   As for the spike_detector, the spikes of the last time slice of a
+   simulation are delivered in the next simulation, and thus fetched
+   with the spikes of the next trial.
+
+   Parameters:
+   The following parameter can be read out, and set to 0 to drop the
+   spikes not fetched yet:
+
+   n_events  int - Number of spikes recorded and not fetched yet
+
+   Example:
+   SLI ] /cursor_spike_recorder Create /sr Set
+   SLI ] neurons sr Connect
+   SLI ] 1000 Simulate
+   SLI ] sr FetchSpikes /trial Set   % << /senders /times >> of trial 1
+   SLI ] 1000 Simulate
+   SLI ] sr FetchSpikes /trial Set   % spikes of trial 2 only
+
+   Receives: SpikeEvent
+
+   SeeAlso: FetchSpikes, spike_detector, compact_spike_recorder
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device keeping the spikes it receives until they are fetched.
+ */
+class cursor_spike_recorder : public nest::DeviceNode
+{
+
+public:
+  cursor_spike_recorder();
+  cursor_spike_recorder( const cursor_spike_recorder& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  //! Spikes are recorded on the thread of their sender
+  bool
+  local_receiver() const
+  {
+    return true;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  void handle( nest::SpikeEvent& );
+
+  nest::port handles_test_event( nest::SpikeEvent&, nest::rport );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  /**
+   * Return the spikes recorded by all thread instances since the last
+   * fetch as << /senders /times >>, sorted by time, and drop them.
+   */
+  DictionaryDatum fetch();
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+
+  void update( nest::Time const&, const long, const long );
+
+  typedef std::pair< long, long > Spike_; //!< step and GID
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+
+  //! Spikes recorded by this instance and not fetched yet
+  std::vector< Spike_ > spikes_;
+};
+
+inline nest::port
+cursor_spike_recorder::handles_test_event( nest::SpikeEvent&,
+  nest::rport receptor_type )
+{
+  if ( receptor_type != 0 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  return 0;
+}
+
+} // namespace mynest
+
+#endif // CURSOR_SPIKE_RECORDER_H
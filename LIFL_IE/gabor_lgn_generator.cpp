@@ -0,0 +1,277 @@
+/*
+ *  gabor_lgn_generator.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gabor_lgn_generator.h"
+
+// C++ includes:
+#include <algorithm>
+#include <cmath>
+
+// Includes from libnestutil:
+#include "numerics.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+namespace
+{
+//! Tags of the random streams of a channel
+const unsigned int spike_tag = 0;
+const unsigned int noise_tag = 1;
+}
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameter
+ * ---------------------------------------------------------------- */
+
+mynest::gabor_lgn_generator::Parameters_::Parameters_()
+  : targets_()
+  , rows_( 18 )
+  , columns_( 18 )
+  , orientation_( 0.0 ) // degrees
+  , phase_( 0.0 )       // degrees
+  , frequency_( 0.125 ) // cycles per cell
+  , sigma_( 4.0 )       // cells
+  , noise_( 0.2 )
+  , rate_( 100.0 )    // spikes/s
+  , baseline_( 0.0 )  // spikes/s
+  , seed_( 0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::gabor_lgn_generator::Parameters_::get( DictionaryDatum& d ) const
+{
+  ( *d )[ names::targets ] =
+    IntVectorDatum( new std::vector< long >( targets_ ) );
+  def< long >( d, names::rows, rows_ );
+  def< long >( d, names::columns, columns_ );
+  def< double >( d, names::orientation, orientation_ );
+  def< double >( d, nest::names::phase, phase_ );
+  def< double >( d, names::spatial_frequency, frequency_ );
+  def< double >( d, names::sigma, sigma_ );
+  def< double >( d, names::noise, noise_ );
+  def< double >( d, nest::names::rate, rate_ );
+  def< double >( d, names::baseline, baseline_ );
+  def< long >( d, names::seed, seed_ );
+}
+
+void
+mynest::gabor_lgn_generator::Parameters_::set( const DictionaryDatum& d )
+{
+  updateValue< std::vector< long > >( d, names::targets, targets_ );
+  updateValue< long >( d, names::rows, rows_ );
+  updateValue< long >( d, names::columns, columns_ );
+  updateValue< double >( d, names::orientation, orientation_ );
+  updateValue< double >( d, nest::names::phase, phase_ );
+  updateValue< double >( d, names::spatial_frequency, frequency_ );
+  updateValue< double >( d, names::sigma, sigma_ );
+  updateValue< double >( d, names::noise, noise_ );
+  updateValue< double >( d, nest::names::rate, rate_ );
+  updateValue< double >( d, names::baseline, baseline_ );
+  updateValue< long >( d, names::seed, seed_ );
+
+  for ( size_t k = 0; k < targets_.size(); ++k )
+  {
+    if ( targets_[ k ] <= 0 )
+    {
+      throw nest::BadProperty( "targets must be GIDs of nodes." );
+    }
+  }
+  if ( rows_ <= 0 or columns_ <= 0 )
+  {
+    throw nest::BadProperty( "rows and columns must be positive." );
+  }
+  if ( sigma_ <= 0 )
+  {
+    throw nest::BadProperty( "sigma must be positive." );
+  }
+  if ( frequency_ < 0 )
+  {
+    throw nest::BadProperty( "spatial_frequency must not be negative." );
+  }
+  if ( noise_ < 0 )
+  {
+    throw nest::BadProperty( "noise must not be negative." );
+  }
+  if ( rate_ < 0 or baseline_ < 0 )
+  {
+    throw nest::BadProperty( "rate and baseline must not be negative." );
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::gabor_lgn_generator::gabor_lgn_generator()
+  : DeviceNode()
+  , device_()
+  , P_()
+{
+}
+
+mynest::gabor_lgn_generator::gabor_lgn_generator(
+  const gabor_lgn_generator& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::gabor_lgn_generator::init_state_( const Node& proto )
+{
+  const gabor_lgn_generator& pr = downcast< gabor_lgn_generator >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::gabor_lgn_generator::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::gabor_lgn_generator::calibrate()
+{
+  device_.calibrate();
+
+  V_.rng_ = CounterRNG( P_.seed_, get_gid() );
+
+  const double theta = P_.orientation_ * numerics::pi / 180.0;
+  const double phase = P_.phase_ * numerics::pi / 180.0;
+  const double h = nest::Time::get_resolution().get_ms();
+
+  const size_t n_channels = P_.rows_ * P_.columns_;
+  V_.lambda_.resize( n_channels );
+  V_.silent_ = true;
+  for ( long r = 0; r < P_.rows_; ++r )
+  {
+    for ( long c = 0; c < P_.columns_; ++c )
+    {
+      const size_t k = r * P_.columns_ + c;
+      const double x = c - 0.5 * ( P_.columns_ - 1 );
+      const double y = 0.5 * ( P_.rows_ - 1 ) - r;
+      const double u = -x * std::sin( theta ) + y * std::cos( theta );
+      const double g =
+        std::exp( -( x * x + y * y ) / ( 2.0 * P_.sigma_ * P_.sigma_ ) )
+        * std::cos( 2.0 * numerics::pi * P_.frequency_ * u + phase );
+
+      // the noise of a channel is fixed for the stimulus
+      const double xi = V_.rng_.normal( 0, k, noise_tag );
+      const double response = std::max( 0.0, g + P_.noise_ * xi );
+
+      V_.lambda_[ k ] = ( P_.baseline_ + P_.rate_ * response ) * h * 1e-3;
+      V_.silent_ = V_.silent_ and V_.lambda_[ k ] <= 0;
+    }
+  }
+
+  V_.channel_of_.clear();
+  for ( size_t k = 0; k < P_.targets_.size() and k < n_channels; ++k )
+  {
+    V_.channel_of_[ P_.targets_[ k ] ] = k;
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and event hook functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::gabor_lgn_generator::update( nest::Time const& origin,
+  const long from,
+  const long to )
+{
+  assert( to >= 0
+    && ( nest::delay ) from
+      < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  if ( V_.silent_ )
+  {
+    return;
+  }
+
+  for ( long lag = from; lag < to; ++lag )
+  {
+    if ( not device_.is_active(
+           nest::Time::step( origin.get_steps() + lag ) ) )
+    {
+      continue;
+    }
+
+    // the spikes of each target are drawn in event_hook
+    nest::DSSpikeEvent se;
+    nest::kernel().event_delivery_manager.send( *this, se, lag );
+  }
+}
+
+void
+mynest::gabor_lgn_generator::event_hook( nest::DSSpikeEvent& e )
+{
+  const std::unordered_map< nest::index, size_t >::const_iterator it =
+    V_.channel_of_.find( e.get_receiver().get_gid() );
+  if ( it == V_.channel_of_.end() )
+  {
+    return; // target without a ganglion cell
+  }
+
+  const size_t channel = it->second;
+  const double lambda = V_.lambda_[ channel ];
+  if ( lambda <= 0 )
+  {
+    return;
+  }
+
+  // counter: step since the origin, so that a stimulus gives the same
+  // spike trains whenever it is presented
+  const long step =
+    e.get_stamp().get_steps() - device_.get_origin().get_steps();
+  const long n_spikes = V_.rng_.poisson( lambda, step, channel, spike_tag );
+  if ( n_spikes > 0 )
+  {
+    e.set_multiplicity( n_spikes );
+    e.get_receiver().handle( e );
+  }
+}
@@ -0,0 +1,251 @@
+/*
+ *  gabor_lgn_generator.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GABOR_LGN_GENERATOR_H
+#define GABOR_LGN_GENERATOR_H
+
+// C++ includes:
+#include <unordered_map>
+#include <vector>
+
+// Includes from nestkernel:
+#include "connection.h"
+#include "device_node.h"
+#include "event.h"
+#include "nest_types.h"
+#include "stimulating_device.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+// Includes from LIFL_IE:
+#include "counter_rng.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: gabor_lgn_generator - Retina/LGN spike trains for a Gabor stimulus.
+
+   Description:
+   The gabor_lgn_generator generates the spike trains of a grid of ganglion
+   cells (rows x columns, 18 x 18 in the V1 examples) looking at a Gabor
+   patch, inside the simulation. It replaces the precomputed Gabor response
+   files, so that orientations, phases, spatial frequencies and noise
+   realizations can be swept without generating and storing spike trains.
+
+   The cell in row r and column c (channel r * columns + c) sits at
+   x = c - (columns - 1) / 2, y = (rows - 1) / 2 - r, in units of the cell
+   spacing. Its response to the stimulus is
+
+     g = exp( -(x^2 + y^2) / (2 sigma^2) ) cos( 2 pi f u + phase ),
+     u = -x sin(orientation) + y cos(orientation),
+
+   so that the bars run at the given orientation, counter-clockwise from
+   the horizontal. Each cell receives a fixed noise term of standard
+   deviation noise, drawn once per stimulus like the randn noise of the
+   response files, and fires as a Poisson process with rate
+
+     baseline + rate * max( 0, g + noise * xi ).
+
+   All random numbers come from a counter-based generator (CounterRNG),
+   keyed by seed and the GID of the generator and indexed by channel and
+   by time step since the origin of the device. The spike trains of a
+   stimulus thus depend only on the parameters, the seed and the GID, not
+   on the number of threads, on which channels are connected, or on when
+   the stimulus is presented. Generators with the same seed, e.g. the
+   default seed 0, still draw independent spike trains. Each thread only
+   draws the spikes of its own targets.
+
+   Channel k is sent to the node targets[k]; the generator is connected to
+   these nodes with any connection rule, typically all_to_all.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   targets            int array - Target node of each channel
+   rows               int       - Rows of the ganglion cell grid
+   columns            int       - Columns of the ganglion cell grid
+   orientation        double    - Orientation of the bars in degrees
+   phase              double    - Phase of the carrier in degrees
+   spatial_frequency  double    - Carrier frequency in cycles per cell
+   sigma              double    - Width of the Gaussian envelope in cells
+   noise              double    - Standard deviation of the response noise
+   rate               double    - Rate at response 1 in spikes/s
+   baseline           double    - Spontaneous rate in spikes/s
+   seed               int       - Seed of the noise and spike trains
+
+   Example:
+   Sweep orientations and noise realizations with one generator:
+
+   lgn_input = nest.Create('gabor_lgn_generator', 1, {
+                   'targets': list(LGN), 'noise': 0.2})
+   nest.Connect(lgn_input, LGN, 'all_to_all')
+   for seed in range(100):
+       for angle in [0.0, 45.0, 90.0, 135.0]:
+           t = nest.GetKernelStatus('time')
+           nest.SetStatus(lgn_input, {'orientation': angle, 'seed': seed,
+                                      'origin': t, 'stop': 200.0})
+           nest.Simulate(300.0)
+
+   Sends: SpikeEvent
+
+   SeeAlso: spike_file_player, poisson_generator
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device generating the ganglion cell spike trains of a Gabor stimulus.
+ */
+class gabor_lgn_generator : public nest::DeviceNode
+{
+
+public:
+  gabor_lgn_generator();
+  gabor_lgn_generator( const gabor_lgn_generator& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::event_hook;
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  nest::port send_test_event( nest::Node&, nest::rport, nest::synindex, bool );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  //! Draw the spikes of the target's channel in the current step
+  void event_hook( nest::DSSpikeEvent& );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+
+  void update( nest::Time const&, const long, const long );
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    std::vector< long > targets_; //!< Target GID per channel
+    long rows_;                   //!< Rows of the grid
+    long columns_;                //!< Columns of the grid
+    double orientation_;          //!< Orientation of the bars in degrees
+    double phase_;                //!< Phase of the carrier in degrees
+    double frequency_;            //!< Spatial frequency in cycles per cell
+    double sigma_;                //!< Envelope width in cells
+    double noise_;                //!< Standard deviation of response noise
+    double rate_;                 //!< Rate at response 1 in spikes/s
+    double baseline_;             //!< Spontaneous rate in spikes/s
+    long seed_;                   //!< Seed of the counter-based RNG
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+    void set( const DictionaryDatum& ); //!< Set values from dictionary
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    CounterRNG rng_;               //!< Keyed by the seed and the GID
+    std::vector< double > lambda_; //!< Mean spikes per step, per channel
+    bool silent_;                  //!< No channel has a positive rate
+
+    //! Channel of each target GID
+    std::unordered_map< nest::index, size_t > channel_of_;
+  };
+
+  // ------------------------------------------------------------
+
+  nest::StimulatingDevice< nest::SpikeEvent > device_;
+  Parameters_ P_;
+  Variables_ V_;
+};
+
+inline nest::port
+gabor_lgn_generator::send_test_event( nest::Node& target,
+  nest::rport receptor_type,
+  nest::synindex syn_id,
+  bool dummy_target )
+{
+  device_.enforce_single_syn_type( syn_id );
+
+  // as for poisson_generator, the events sent pass through event_hook,
+  // which draws the spikes of each target
+  if ( dummy_target )
+  {
+    nest::DSSpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+  else
+  {
+    nest::SpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+}
+
+inline void
+gabor_lgn_generator::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+}
+
+inline void
+gabor_lgn_generator::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_; // temporary copy in case of errors
+  ptmp.set( d );         // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+}
+
+} // namespace mynest
+
+#endif // GABOR_LGN_GENERATOR_H
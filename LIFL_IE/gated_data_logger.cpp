@@ -0,0 +1,147 @@
+/*
+ *  gated_data_logger.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gated_data_logger.h"
+
+// C++ includes:
+#include <algorithm>
+#include <limits>
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+mynest::RecordingGate::RecordingGate()
+  : windows_()
+  , period_( 0.0 ) // ms, windows in absolute time
+{
+}
+
+void
+mynest::RecordingGate::get( DictionaryDatum& d ) const
+{
+  ( *d )[ names::record_windows ] =
+    DoubleVectorDatum( new std::vector< double >( windows_ ) );
+  def< double >( d, names::record_period, period_ );
+}
+
+void
+mynest::RecordingGate::set( const DictionaryDatum& d )
+{
+  std::vector< double > windows = windows_;
+  double period = period_;
+  updateValue< std::vector< double > >( d, names::record_windows, windows );
+  updateValue< double >( d, names::record_period, period );
+
+  if ( windows.size() % 2 != 0 )
+  {
+    throw nest::BadProperty(
+      "record_windows must hold pairs of start and stop times." );
+  }
+  for ( size_t k = 0; k < windows.size(); ++k )
+  {
+    // stops after starts, windows in increasing order
+    if ( k > 0 and windows[ k ] < windows[ k - 1 ] )
+    {
+      throw nest::BadProperty(
+        "record_windows must be increasing and must not overlap." );
+    }
+  }
+  for ( size_t k = 0; k < windows.size(); k += 2 )
+  {
+    if ( windows[ k ] == windows[ k + 1 ] )
+    {
+      throw nest::BadProperty( "record_windows must not be empty." );
+    }
+  }
+  if ( period < 0 )
+  {
+    throw nest::BadProperty( "record_period must not be negative." );
+  }
+  if ( period > 0 and not windows.empty()
+    and ( windows.front() < 0 or windows.back() > period ) )
+  {
+    throw nest::BadProperty(
+      "With record_period, record_windows must lie within the period." );
+  }
+
+  windows_.swap( windows );
+  period_ = period;
+}
+
+bool
+mynest::RecordingGate::operator==( const RecordingGate& g ) const
+{
+  return windows_ == g.windows_ and period_ == g.period_;
+}
+
+bool
+mynest::RecordingGate::is_open( const long stamp, long& next_change ) const
+{
+  if ( windows_.empty() )
+  {
+    next_change = std::numeric_limits< long >::max();
+    return true;
+  }
+
+  const double t_stamp = nest::Time( nest::Time::step( stamp ) ).get_ms();
+  double offset = 0.0;
+  if ( period_ > 0 )
+  {
+    offset = std::floor( t_stamp / period_ ) * period_;
+  }
+  const double t = t_stamp - offset;
+
+  // the first stop after t belongs to the window containing t or following
+  // it; windows_ is sorted
+  const size_t k =
+    std::upper_bound( windows_.begin(), windows_.end(), t ) - windows_.begin();
+
+  double change;
+  if ( k == windows_.size() )
+  {
+    // after the last window
+    change = period_ > 0 ? offset + period_
+                         : std::numeric_limits< double >::infinity();
+  }
+  else
+  {
+    change = offset + windows_[ k ];
+  }
+
+  if ( std::isinf( change ) )
+  {
+    next_change = std::numeric_limits< long >::max();
+  }
+  else
+  {
+    next_change = std::max(
+      stamp + 1, nest::Time( nest::Time::ms_stamp( change ) ).get_steps() );
+  }
+
+  // an odd index is the stop of the window containing t
+  return k % 2 == 1;
+}
@@ -0,0 +1,441 @@
+/*
+ *  gated_data_logger.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GATED_DATA_LOGGER_H
+#define GATED_DATA_LOGGER_H
+
+// C++ includes:
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Includes from nestkernel:
+#include "event.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+#include "nest_time.h"
+#include "nest_types.h"
+#include "recordables_map.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+
+/**
+ * Time windows in which the analog recordables of a neuron are sampled.
+ *
+ * The windows are [start, stop) intervals in ms, given as one flat list
+ * start_0, stop_0, start_1, stop_1, ... in increasing order. With a
+ * period, the windows are taken modulo the period, e.g. relative to the
+ * onsets of trials of that period. Without windows, the gate is always
+ * open.
+ *
+ * The gate is a parameter, it holds no state and may be shared by the
+ * neurons of a model.
+ */
+class RecordingGate
+{
+public:
+  RecordingGate();
+
+  void get( DictionaryDatum& ) const;
+
+  //! Set from dictionary, throws BadProperty if inconsistent
+  void set( const DictionaryDatum& );
+
+  bool operator==( const RecordingGate& ) const;
+
+  /**
+   * Tell whether a sample with the given time stamp (in steps) is
+   * recorded.
+   * @param stamp        Time stamp of the sample.
+   * @param next_change  Set to the first later stamp at which the
+   *                     result may differ.
+   */
+  bool is_open( const long stamp, long& next_change ) const;
+
+private:
+  std::vector< double > windows_; //!< start, stop pairs in ms
+  double period_;                 //!< ms, 0 for windows in absolute time
+};
+
+/**
+ * Data logger for the analog recordables of a neuron, sampling them only
+ * while a RecordingGate is open.
+ *
+ * It is a drop-in replacement of nest::UniversalDataLogger and serves
+ * multimeters in the same way. Samples outside the windows are neither
+ * read from the neuron nor stored or sent; the gate is evaluated once per
+ * opening or closing, not in every step. When the gate opens, sampling
+ * continues on the grid of the recording interval of the multimeter.
+ */
+template < typename HostNode >
+class GatedDataLogger
+{
+public:
+  GatedDataLogger( HostNode& );
+
+  //! Add a multimeter, returns the rport of the connection
+  nest::port connect_logging_device( const nest::DataLoggingRequest&,
+    const nest::RecordablesMap< HostNode >& );
+
+  //! Send the data of the last slice to the multimeter
+  void handle( const nest::DataLoggingRequest& );
+
+  //! Record the recordables after the update of step, if the gate is open
+  void record_data( long step );
+
+  //! Clear the recorded data
+  void reset();
+
+  /**
+   * Prepare for recording with the given gate. The gate must stay valid
+   * until the next call of init(), so call it in calibrate().
+   */
+  void init( const RecordingGate& );
+
+private:
+  /**
+   * Recording for one multimeter.
+   */
+  class DataLogger_
+  {
+  public:
+    DataLogger_( const nest::DataLoggingRequest&,
+      const nest::RecordablesMap< HostNode >& );
+
+    nest::index
+    get_mm_gid() const
+    {
+      return multimeter_;
+    }
+
+    void handle( HostNode&, const nest::DataLoggingRequest& );
+    void record_data( const HostNode&, long );
+    void reset();
+    void init();
+
+  private:
+    nest::index multimeter_; //!< GID of the multimeter
+    size_t num_vars_;        //!< Number of recordables
+
+    nest::Time recording_interval_;
+    long rec_int_steps_;
+    long next_rec_step_; //!< Next step to record, -1 if uninitialized
+
+    //! Functions reading the recordables from the host
+    std::vector< typename nest::RecordablesMap< HostNode >::DataAccessFct >
+      node_access_;
+
+    //! Two buffers, written and read in alternate slices
+    std::vector< nest::DataLoggingReply::Container > data_;
+
+    //! Next buffer entry to write
+    std::vector< size_t > next_rec_;
+  };
+
+  HostNode& host_;
+  std::vector< DataLogger_ > data_loggers_;
+
+  const RecordingGate* gate_;
+  bool gate_open_;
+  long gate_next_change_; //!< Stamp at which the gate is evaluated again
+};
+
+template < typename HostNode >
+GatedDataLogger< HostNode >::GatedDataLogger( HostNode& host )
+  : host_( host )
+  , data_loggers_()
+  , gate_( 0 )
+  , gate_open_( true )
+  , gate_next_change_( 0 )
+{
+}
+
+template < typename HostNode >
+nest::port
+GatedDataLogger< HostNode >::connect_logging_device(
+  const nest::DataLoggingRequest& req,
+  const nest::RecordablesMap< HostNode >& rmap )
+{
+  // rports are assigned consecutively, the caller may not request one
+  if ( req.get_rport() != 0 )
+  {
+    throw nest::IllegalConnection(
+      "Connections from multimeter to node must request rport 0." );
+  }
+
+  const nest::index mm_gid = req.get_sender().get_gid();
+  for ( size_t j = 0; j < data_loggers_.size(); ++j )
+  {
+    if ( data_loggers_[ j ].get_mm_gid() == mm_gid )
+    {
+      throw nest::IllegalConnection(
+        "Each multimeter can only be connected once to a given node." );
+    }
+  }
+
+  data_loggers_.push_back( DataLogger_( req, rmap ) );
+
+  // rport is index plus one, i.e., 0 is invalid rport
+  return data_loggers_.size();
+}
+
+template < typename HostNode >
+void
+GatedDataLogger< HostNode >::handle( const nest::DataLoggingRequest& dlr )
+{
+  const long rport = dlr.get_rport();
+  assert( rport >= 1 );
+  assert( static_cast< size_t >( rport ) <= data_loggers_.size() );
+  data_loggers_[ rport - 1 ].handle( host_, dlr );
+}
+
+template < typename HostNode >
+inline void
+GatedDataLogger< HostNode >::record_data( long step )
+{
+  if ( data_loggers_.empty() )
+  {
+    return;
+  }
+
+  // the sample recorded after the update of step is stamped step + 1
+  const long stamp = step + 1;
+  if ( stamp >= gate_next_change_ )
+  {
+    gate_open_ = gate_->is_open( stamp, gate_next_change_ );
+  }
+  if ( not gate_open_ )
+  {
+    return;
+  }
+
+  for ( size_t j = 0; j < data_loggers_.size(); ++j )
+  {
+    data_loggers_[ j ].record_data( host_, step );
+  }
+}
+
+template < typename HostNode >
+void
+GatedDataLogger< HostNode >::reset()
+{
+  for ( size_t j = 0; j < data_loggers_.size(); ++j )
+  {
+    data_loggers_[ j ].reset();
+  }
+}
+
+template < typename HostNode >
+void
+GatedDataLogger< HostNode >::init( const RecordingGate& gate )
+{
+  gate_ = &gate;
+  gate_next_change_ = 0; // evaluate the gate at the next sample
+
+  for ( size_t j = 0; j < data_loggers_.size(); ++j )
+  {
+    data_loggers_[ j ].init();
+  }
+}
+
+template < typename HostNode >
+GatedDataLogger< HostNode >::DataLogger_::DataLogger_(
+  const nest::DataLoggingRequest& req,
+  const nest::RecordablesMap< HostNode >& rmap )
+  : multimeter_( req.get_sender().get_gid() )
+  , num_vars_( 0 )
+  , recording_interval_( nest::Time::neg_inf() )
+  , rec_int_steps_( 0 )
+  , next_rec_step_( -1 )
+  , node_access_()
+  , data_()
+  , next_rec_( 2, 0 )
+{
+  const std::vector< Name >& recvars = req.record_from();
+  for ( size_t j = 0; j < recvars.size(); ++j )
+  {
+    typename nest::RecordablesMap< HostNode >::const_iterator rec =
+      rmap.find( recvars[ j ] );
+    if ( rec == rmap.end() )
+    {
+      // the connection either succeeds for all recordables or fails
+      node_access_.clear();
+      throw nest::IllegalConnection(
+        "Cannot connect with unknown recordable " + recvars[ j ].toString() );
+    }
+    node_access_.push_back( rec->second );
+  }
+
+  num_vars_ = node_access_.size();
+
+  if ( num_vars_ > 0
+    and req.get_recording_interval() < nest::Time::step( 1 ) )
+  {
+    throw nest::IllegalConnection(
+      "Recording interval must be >= resolution." );
+  }
+
+  recording_interval_ = req.get_recording_interval();
+}
+
+template < typename HostNode >
+void
+GatedDataLogger< HostNode >::DataLogger_::init()
+{
+  if ( num_vars_ < 1 )
+  {
+    return;
+  }
+
+  // the buffers are initialized if the next recording step is in the
+  // current slice or beyond
+  if ( next_rec_step_
+    >= nest::kernel().simulation_manager.get_slice_origin().get_steps() )
+  {
+    return;
+  }
+
+  data_.clear();
+
+  rec_int_steps_ = recording_interval_.get_steps();
+
+  // time stamps at the right end of the update interval are multiples of
+  // the recording interval
+  next_rec_step_ =
+    ( nest::kernel().simulation_manager.get_time().get_steps()
+          / rec_int_steps_
+        + 1 )
+      * rec_int_steps_
+    - 1;
+
+  const long recs_per_slice = static_cast< long >(
+    std::ceil( nest::kernel().connection_manager.get_min_delay()
+      / static_cast< double >( rec_int_steps_ ) ) );
+
+  data_.resize( 2,
+    nest::DataLoggingReply::Container(
+      recs_per_slice, nest::DataLoggingReply::Item( num_vars_ ) ) );
+
+  next_rec_.resize( 2 );
+  next_rec_[ 0 ] = next_rec_[ 1 ] = 0;
+}
+
+template < typename HostNode >
+void
+GatedDataLogger< HostNode >::DataLogger_::reset()
+{
+  data_.clear();
+  next_rec_step_ = -1;
+}
+
+template < typename HostNode >
+inline void
+GatedDataLogger< HostNode >::DataLogger_::record_data( const HostNode& host,
+  long step )
+{
+  if ( num_vars_ < 1 or step < next_rec_step_ )
+  {
+    return;
+  }
+
+  // skip the sampling points passed while the gate was closed, the next
+  // one may lie beyond step
+  next_rec_step_ +=
+    ( ( step - next_rec_step_ ) / rec_int_steps_ ) * rec_int_steps_;
+  if ( step != next_rec_step_ )
+  {
+    return;
+  }
+
+  const size_t wt = nest::kernel().event_delivery_manager.write_toggle();
+  assert( wt < next_rec_.size() );
+  assert( wt < data_.size() );
+
+  // may happen if the multimeter is frozen
+  if ( next_rec_[ wt ] >= data_[ wt ].size() )
+  {
+    return;
+  }
+
+  nest::DataLoggingReply::Item& dest = data_[ wt ][ next_rec_[ wt ] ];
+  dest.timestamp = nest::Time::step( step + 1 );
+  for ( size_t j = 0; j < num_vars_; ++j )
+  {
+    dest.data[ j ] = ( ( host ).*( node_access_[ j ] ) )();
+  }
+
+  next_rec_step_ += rec_int_steps_;
+  ++next_rec_[ wt ];
+}
+
+template < typename HostNode >
+void
+GatedDataLogger< HostNode >::DataLogger_::handle( HostNode& host,
+  const nest::DataLoggingRequest& request )
+{
+  if ( num_vars_ < 1 )
+  {
+    return;
+  }
+
+  assert( next_rec_.size() == 2 );
+  assert( data_.size() == 2 );
+
+  const size_t rt = nest::kernel().event_delivery_manager.read_toggle();
+  assert( not data_[ rt ].empty() );
+
+  // nothing was recorded in the last slice, because the gate was closed
+  // or the node frozen
+  if ( next_rec_[ rt ] == 0
+    or data_[ rt ][ 0 ].timestamp
+      <= nest::kernel().simulation_manager.get_previous_slice_origin() )
+  {
+    next_rec_[ rt ] = 0;
+    return;
+  }
+
+  // mark the end of the valid data
+  if ( next_rec_[ rt ] < data_[ rt ].size() )
+  {
+    data_[ rt ][ next_rec_[ rt ] ].timestamp = nest::Time::neg_inf();
+  }
+
+  nest::DataLoggingReply reply( data_[ rt ] );
+
+  next_rec_[ rt ] = 0;
+
+  reply.set_sender( host );
+  reply.set_sender_gid( host.get_gid() );
+  reply.set_receiver( request.get_sender() );
+  reply.set_port( request.get_port() );
+
+  nest::kernel().event_delivery_manager.send_to_node( reply );
+}
+
+} // namespace mynest
+
+#endif // GATED_DATA_LOGGER_H
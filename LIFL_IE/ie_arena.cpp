@@ -0,0 +1,164 @@
+/*
+ *  ie_arena.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ie_arena.h"
+
+// C++ includes:
+#include <new>
+
+mynest::IEArena&
+mynest::IEArena::local()
+{
+  // deliberately leaked, see class documentation
+  static thread_local IEArena* arena = 0;
+  if ( arena == 0 )
+  {
+    arena = new IEArena();
+  }
+  return *arena;
+}
+
+mynest::IEArena::IEArena()
+  : next_( 0 )
+  , end_( 0 )
+  , has_remote_( false )
+{
+  for ( size_t c = 0; c < n_classes_; ++c )
+  {
+    free_[ c ] = 0;
+    remote_[ c ] = 0;
+  }
+}
+
+size_t
+mynest::IEArena::size_class_( size_t bytes )
+{
+  const size_t total = bytes + sizeof( BlockHeader_ );
+  size_t c = min_class_;
+  while ( ( static_cast< size_t >( 1 ) << c ) < total )
+  {
+    ++c;
+  }
+  return c;
+}
+
+void*
+mynest::IEArena::allocate( size_t bytes )
+{
+  const size_t c = size_class_( bytes );
+
+  if ( c > max_class_ )
+  {
+    BlockHeader_* h = static_cast< BlockHeader_* >(
+      ::operator new( bytes + sizeof( BlockHeader_ ) ) );
+    h->owner_ = 0;
+    h->size_class_ = c;
+    return h + 1;
+  }
+
+  const size_t i = c - min_class_;
+  if ( free_[ i ] == 0 and has_remote_.load( std::memory_order_acquire ) )
+  {
+    reclaim_remote_();
+  }
+
+  BlockHeader_* h;
+  if ( free_[ i ] != 0 )
+  {
+    FreeBlock_* f = free_[ i ];
+    free_[ i ] = f->next_;
+    h = reinterpret_cast< BlockHeader_* >( f ) - 1;
+  }
+  else
+  {
+    h = static_cast< BlockHeader_* >( carve_( c ) );
+    h->owner_ = this;
+    h->size_class_ = c;
+  }
+  return h + 1;
+}
+
+void
+mynest::IEArena::release( void* p )
+{
+  if ( p == 0 )
+  {
+    return;
+  }
+
+  BlockHeader_* h = static_cast< BlockHeader_* >( p ) - 1;
+  IEArena* owner = h->owner_;
+  if ( owner == 0 )
+  {
+    ::operator delete( h );
+    return;
+  }
+
+  FreeBlock_* f = static_cast< FreeBlock_* >( p );
+  const size_t i = h->size_class_ - min_class_;
+  if ( owner == &local() )
+  {
+    f->next_ = owner->free_[ i ];
+    owner->free_[ i ] = f;
+  }
+  else
+  {
+    std::lock_guard< std::mutex > lock( owner->remote_mutex_ );
+    f->next_ = owner->remote_[ i ];
+    owner->remote_[ i ] = f;
+    owner->has_remote_.store( true, std::memory_order_release );
+  }
+}
+
+void*
+mynest::IEArena::carve_( size_t c )
+{
+  const size_t block = static_cast< size_t >( 1 ) << c;
+  if ( next_ == 0 or static_cast< size_t >( end_ - next_ ) < block )
+  {
+    // the tail of the previous slab is too small for this class and is
+    // left unused; slabs come from operator new and are 16 byte aligned
+    next_ = static_cast< char* >( ::operator new( slab_size_ ) );
+    end_ = next_ + slab_size_;
+    slabs_.push_back( next_ );
+  }
+  void* p = next_;
+  next_ += block;
+  return p;
+}
+
+void
+mynest::IEArena::reclaim_remote_()
+{
+  std::lock_guard< std::mutex > lock( remote_mutex_ );
+  for ( size_t i = 0; i < n_classes_; ++i )
+  {
+    while ( remote_[ i ] != 0 )
+    {
+      FreeBlock_* f = remote_[ i ];
+      remote_[ i ] = f->next_;
+      f->next_ = free_[ i ];
+      free_[ i ] = f;
+    }
+  }
+  has_remote_.store( false, std::memory_order_release );
+}
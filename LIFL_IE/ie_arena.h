@@ -0,0 +1,159 @@
+/*
+ *  ie_arena.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IE_ARENA_H
+#define IE_ARENA_H
+
+// C++ includes:
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace mynest
+{
+
+/**
+ * Per-thread arena for the IE bookkeeping of lifl_psc_exp_ie.
+ *
+ * Memory is carved from large slabs in power-of-two size classes and
+ * recycled through one free list per class. Every thread allocates from
+ * its own arena, so node creation and the growth of spike histories do
+ * not go through the global heap and threads do not contend for it.
+ *
+ * A block released by a thread other than the one that allocated it is
+ * handed back to the owning arena through a mutex-protected list, which
+ * the owner drains the next time it runs out of free blocks of a class.
+ * Requests beyond the largest class go to operator new.
+ *
+ * Arenas are never destroyed, as blocks may outlive the thread that
+ * allocated them; the slabs are recycled for the lifetime of the process.
+ */
+class IEArena
+{
+public:
+  //! Arena of the calling thread, created on first use
+  static IEArena& local();
+
+  //! Allocate at least the given number of bytes, aligned to 16 bytes
+  void* allocate( size_t );
+
+  //! Return a block obtained from allocate() of any arena
+  static void release( void* );
+
+  //! Bytes currently held in slabs by this arena
+  size_t
+  reserved() const
+  {
+    return slabs_.size() * slab_size_;
+  }
+
+private:
+  IEArena();
+  IEArena( const IEArena& );
+  IEArena& operator=( const IEArena& );
+
+  /**
+   * Header in front of every block, padded to keep the payload 16 byte
+   * aligned.
+   */
+  struct alignas( 16 ) BlockHeader_
+  {
+    IEArena* owner_;    //!< arena to return the block to, 0 for large blocks
+    size_t size_class_; //!< block size is 1 << size_class_
+  };
+
+  //! Payload of a free block links to the next free block of its class
+  struct FreeBlock_
+  {
+    FreeBlock_* next_;
+  };
+
+  static const size_t min_class_ = 5;  //!< 32 bytes, header included
+  static const size_t max_class_ = 16; //!< 64 KiB
+  static const size_t n_classes_ = max_class_ - min_class_ + 1;
+  static const size_t slab_size_ = 1 << 20;
+
+  static size_t size_class_( size_t );
+  void* carve_( size_t );
+  void reclaim_remote_();
+
+  std::vector< char* > slabs_;
+  char* next_; //!< first unused byte of the current slab
+  char* end_;  //!< end of the current slab
+
+  FreeBlock_* free_[ n_classes_ ];
+
+  std::mutex remote_mutex_;
+  FreeBlock_* remote_[ n_classes_ ]; //!< released by other threads
+  std::atomic< bool > has_remote_;
+};
+
+/**
+ * Standard allocator drawing from the arena of the calling thread, for
+ * containers holding IE bookkeeping.
+ */
+template < typename T >
+class IEArenaAllocator
+{
+public:
+  typedef T value_type;
+
+  IEArenaAllocator()
+  {
+  }
+
+  template < typename U >
+  IEArenaAllocator( const IEArenaAllocator< U >& )
+  {
+  }
+
+  T*
+  allocate( size_t n )
+  {
+    return static_cast< T* >( IEArena::local().allocate( n * sizeof( T ) ) );
+  }
+
+  void
+  deallocate( T* p, size_t )
+  {
+    IEArena::release( p );
+  }
+};
+
+template < typename T, typename U >
+inline bool operator==( const IEArenaAllocator< T >&,
+  const IEArenaAllocator< U >& )
+{
+  return true;
+}
+
+template < typename T, typename U >
+inline bool operator!=( const IEArenaAllocator< T >&,
+  const IEArenaAllocator< U >& )
+{
+  return false;
+}
+
+} // namespace mynest
+
+#endif // IE_ARENA_H
@@ -0,0 +1,165 @@
+/*
+ *  ie_recorder.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ie_recorder.h"
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "integerdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default state
+ * ---------------------------------------------------------------- */
+
+mynest::ie_recorder::State_::State_()
+  : senders_()
+  , times_()
+  , enhancement_()
+  , delta_()
+{
+}
+
+/* ----------------------------------------------------------------
+ * State extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::ie_recorder::State_::get( DictionaryDatum& d ) const
+{
+  DictionaryDatum events;
+  if ( d->known( nest::names::events ) )
+  {
+    events = getValue< DictionaryDatum >( d, nest::names::events );
+  }
+  else
+  {
+    events = DictionaryDatum( new Dictionary );
+    ( *d )[ nest::names::events ] = events;
+  }
+
+  initialize_property_intvector( events, nest::names::senders );
+  append_property( events, nest::names::senders, senders_ );
+  initialize_property_doublevector( events, nest::names::times );
+  append_property( events, nest::names::times, times_ );
+  initialize_property_doublevector( events, nest::names::soma_exc );
+  append_property( events, nest::names::soma_exc, enhancement_ );
+  initialize_property_doublevector( events, names::delta );
+  append_property( events, names::delta, delta_ );
+
+  long n_events = 0;
+  updateValue< long >( d, nest::names::n_events, n_events );
+  def< long >( d, nest::names::n_events, n_events + senders_.size() );
+}
+
+void
+mynest::ie_recorder::State_::set( const DictionaryDatum& d )
+{
+  long n_events;
+  if ( updateValue< long >( d, nest::names::n_events, n_events ) )
+  {
+    if ( n_events != 0 )
+    {
+      throw nest::BadProperty( "n_events can only be set to 0." );
+    }
+    senders_.clear();
+    times_.clear();
+    enhancement_.clear();
+    delta_.clear();
+  }
+}
+
+void
+mynest::ie_recorder::get_status( DictionaryDatum& d ) const
+{
+  device_.get_status( d );
+  S_.get( d );
+
+  // the instance on thread 0 also collects the events of the other threads
+  if ( get_thread() == 0 )
+  {
+    const nest::SiblingContainer* siblings =
+      nest::kernel().node_manager.get_thread_siblings( get_gid() );
+    std::vector< nest::Node* >::const_iterator sibling;
+    for ( sibling = siblings->begin() + 1; sibling != siblings->end();
+          ++sibling )
+    {
+      ( *sibling )->get_status( d );
+    }
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::ie_recorder::ie_recorder()
+  : DeviceNode()
+  , device_()
+  , S_()
+{
+}
+
+mynest::ie_recorder::ie_recorder( const ie_recorder& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , S_( n.S_ )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::ie_recorder::init_state_( const Node& proto )
+{
+  const ie_recorder& pr = downcast< ie_recorder >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::ie_recorder::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::ie_recorder::calibrate()
+{
+  device_.calibrate();
+}
+
+void
+mynest::ie_recorder::update( nest::Time const&, const long, const long )
+{
+  // the neurons push their changes, see record
+}
@@ -0,0 +1,165 @@
+/*
+ *  ie_recorder.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IE_RECORDER_H
+#define IE_RECORDER_H
+
+// C++ includes:
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: ie_recorder - Records the changes of intrinsic excitability.
+
+   Description:
+   The ie_recorder records the IE enhancement (soma_exc) of
+   lifl_psc_exp_ie neurons each time it changes, i.e. when a spike of
+   one of their IE modulators arrives, instead of sampling it in every
+   step like a multimeter. The storage needed grows with the number of
+   modulator spikes, not with the simulated time.
+
+   Each event holds the neuron (senders), the time of the modulator spike
+   (times), the enhancement after the change (soma_exc) and the change
+   (delta). The enhancement is constant between events; its value before
+   the first event is the soma_exc of the neuron at that time minus delta.
+   Changes made with SetStatus are not recorded.
+
+   Neurons are connected with ConnectIERecorder, not with Connect. The
+   events of a neuron are in the order of time; with several threads the
+   events of different neurons may be interleaved.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   events      dict - Recorded changes: senders, times (ms), soma_exc
+                      and delta
+   n_events    int  - Number of events recorded, set to 0 to clear
+
+   Example:
+   ie = nest.Create('ie_recorder')
+   nest.sli_func('ConnectIERecorder', ie[0], list(neurons))
+   nest.Simulate(1000.0)
+   events = nest.GetStatus(ie, 'events')[0]
+
+   SeeAlso: ConnectIERecorder, lifl_psc_exp_ie, multimeter
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device recording the changes of the IE enhancement of neurons.
+ */
+class ie_recorder : public nest::DeviceNode
+{
+
+public:
+  ie_recorder();
+  ie_recorder( const ie_recorder& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  /**
+   * Record that the enhancement of neuron gid changed by delta to
+   * enhancement at time t. Called by the neuron on its own thread, i.e.
+   * on the instance of the recorder for that thread.
+   */
+  void
+  record( const long gid,
+    const double t,
+    const double enhancement,
+    const double delta )
+  {
+    if ( device_.is_active( nest::Time::ms( t ) ) )
+    {
+      S_.senders_.push_back( gid );
+      S_.times_.push_back( t );
+      S_.enhancement_.push_back( enhancement );
+      S_.delta_.push_back( delta );
+    }
+  }
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+
+  void update( nest::Time const&, const long, const long );
+
+  // ------------------------------------------------------------
+
+  /**
+   * State variables of the model, per thread.
+   */
+  struct State_
+  {
+    std::vector< long > senders_;
+    std::vector< double > times_;
+    std::vector< double > enhancement_;
+    std::vector< double > delta_;
+
+    State_(); //!< Default initialization
+
+    //! Append the events to those in the dictionary
+    void get( DictionaryDatum& ) const;
+    void set( const DictionaryDatum& );
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  State_ S_;
+};
+
+inline void
+ie_recorder::set_status( const DictionaryDatum& d )
+{
+  State_ stmp = S_;
+  stmp.set( d ); // throws if BadProperty
+
+  // We now know that stmp is consistent. We do not write it back
+  // to S_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  S_ = stmp;
+}
+
+} // namespace mynest
+
+#endif // IE_RECORDER_H
@@ -0,0 +1,391 @@
+/*
+ *  latency_recorder.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "latency_recorder.h"
+
+// C++ includes:
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_names.h"
+#include "nest_time.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::latency_recorder::Parameters_::Parameters_()
+  : trial_period_( 1000.0 ) // ms
+  , window_( 0.0 )          // ms, the whole trial
+{
+}
+
+mynest::latency_recorder::State_::State_()
+  : neurons_()
+  , latencies_()
+  , n_spikes_()
+  , n_detected_()
+  , detections_()
+  , delta_n_()
+  , delta_mean_()
+  , delta_m2_()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extractions and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::latency_recorder::Parameters_::get( DictionaryDatum& d ) const
+{
+  def< double >( d, names::trial_period, trial_period_ );
+  def< double >( d, names::window, window_ );
+}
+
+void
+mynest::latency_recorder::Parameters_::set( const DictionaryDatum& d,
+  const bool evaluated )
+{
+  const double trial_period = trial_period_;
+  const double window = window_;
+  updateValue< double >( d, names::trial_period, trial_period_ );
+  updateValue< double >( d, names::window, window_ );
+  if ( evaluated and ( trial_period_ != trial_period or window_ != window ) )
+  {
+    throw nest::BadProperty( "trial_period and window cannot be changed "
+                             "once trials have been evaluated." );
+  }
+  if ( trial_period_ < nest::Time::get_resolution().get_ms() )
+  {
+    throw nest::BadProperty(
+      "trial_period must be at least the simulation resolution." );
+  }
+  if ( window_ < 0 or window_ > trial_period_ )
+  {
+    throw nest::BadProperty( "window must be in [0, trial_period]." );
+  }
+}
+
+void
+mynest::latency_recorder::State_::get( DictionaryDatum& d ) const
+{
+  ( *d )[ names::neurons ] =
+    IntVectorDatum( new std::vector< long >( neurons_ ) );
+  def< long >( d, names::n_trials, n_detected_.size() );
+  ( *d )[ names::latencies ] =
+    DoubleVectorDatum( new std::vector< double >( latencies_ ) );
+  ( *d )[ names::n_spikes ] =
+    IntVectorDatum( new std::vector< long >( n_spikes_ ) );
+  ( *d )[ names::n_detected ] =
+    IntVectorDatum( new std::vector< long >( n_detected_ ) );
+  ( *d )[ names::detections ] =
+    IntVectorDatum( new std::vector< long >( detections_ ) );
+  ( *d )[ names::delta_n ] =
+    IntVectorDatum( new std::vector< long >( delta_n_ ) );
+
+  std::vector< double >* mean = new std::vector< double >( delta_n_.size() );
+  std::vector< double >* sd = new std::vector< double >( delta_n_.size() );
+  for ( size_t p = 0; p < delta_n_.size(); ++p )
+  {
+    ( *mean )[ p ] = delta_n_[ p ] > 0
+      ? delta_mean_[ p ]
+      : std::numeric_limits< double >::quiet_NaN();
+    ( *sd )[ p ] = delta_n_[ p ] > 1
+      ? std::sqrt( delta_m2_[ p ] / ( delta_n_[ p ] - 1 ) )
+      : std::numeric_limits< double >::quiet_NaN();
+  }
+  ( *d )[ names::delta_mean ] = DoubleVectorDatum( mean );
+  ( *d )[ names::delta_std ] = DoubleVectorDatum( sd );
+}
+
+void
+mynest::latency_recorder::State_::set_neurons(
+  const std::vector< long >& neurons )
+{
+  const size_t n = neurons.size();
+  neurons_ = neurons;
+  detections_.assign( n, 0 );
+  delta_n_.assign( n * n, 0 );
+  delta_mean_.assign( n * n, 0.0 );
+  delta_m2_.assign( n * n, 0.0 );
+}
+
+void
+mynest::latency_recorder::State_::add_trial(
+  const std::vector< double >& latencies,
+  const std::vector< long >& n_spikes )
+{
+  const size_t n = neurons_.size();
+  latencies_.insert( latencies_.end(), latencies.begin(), latencies.end() );
+  n_spikes_.insert( n_spikes_.end(), n_spikes.begin(), n_spikes.end() );
+
+  long n_detected = 0;
+  for ( size_t i = 0; i < n; ++i )
+  {
+    if ( std::isnan( latencies[ i ] ) )
+    {
+      continue;
+    }
+    ++n_detected;
+    ++detections_[ i ];
+
+    // running mean and variance of the differences (Welford)
+    for ( size_t j = 0; j < n; ++j )
+    {
+      if ( j == i or std::isnan( latencies[ j ] ) )
+      {
+        continue;
+      }
+      const size_t p = i * n + j;
+      const double delta = latencies[ i ] - latencies[ j ];
+      ++delta_n_[ p ];
+      const double dev = delta - delta_mean_[ p ];
+      delta_mean_[ p ] += dev / delta_n_[ p ];
+      delta_m2_[ p ] += dev * ( delta - delta_mean_[ p ] );
+    }
+  }
+  n_detected_.push_back( n_detected );
+}
+
+void
+mynest::latency_recorder::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+
+  // the instance on thread 0 holds the results of all threads
+  if ( get_thread() == 0 )
+  {
+    S_.get( d );
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::latency_recorder::latency_recorder()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , S_()
+  , B_()
+  , V_()
+{
+  B_.n_evaluated_ = 0;
+}
+
+mynest::latency_recorder::latency_recorder( const latency_recorder& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , S_()
+  , B_()
+  , V_()
+{
+  B_.n_evaluated_ = 0;
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::latency_recorder::init_state_( const Node& proto )
+{
+  const latency_recorder& pr = downcast< latency_recorder >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::latency_recorder::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::latency_recorder::calibrate()
+{
+  device_.calibrate();
+
+  V_.onset_steps_ =
+    device_.get_origin().get_steps() + device_.get_start().get_steps();
+  V_.trial_steps_ =
+    nest::Time( nest::Time::ms( P_.trial_period_ ) ).get_steps();
+  V_.window_steps_ = P_.window_ > 0
+    ? nest::Time( nest::Time::ms( P_.window_ ) ).get_steps()
+    : V_.trial_steps_;
+}
+
+void
+mynest::latency_recorder::post_run_cleanup()
+{
+  // the other instances do not touch their buffers here, and no spikes
+  // are delivered until the next simulation
+  if ( get_thread() == 0 )
+  {
+    evaluate_();
+  }
+}
+
+void
+mynest::latency_recorder::evaluate_()
+{
+  // the spikes up to this step have been delivered; the window of trial k
+  // covers the steps [onset + k * trial_steps, ... + window_steps)
+  const long delivered =
+    nest::kernel().simulation_manager.get_time().get_steps()
+    - nest::kernel().connection_manager.get_min_delay();
+  const long last_step =
+    delivered - V_.onset_steps_ - V_.window_steps_ + 1;
+  const long n_complete =
+    last_step < 0 ? 0 : last_step / V_.trial_steps_ + 1;
+  if ( n_complete <= B_.n_evaluated_ )
+  {
+    return;
+  }
+
+  const nest::SiblingContainer* siblings =
+    nest::kernel().node_manager.get_thread_siblings( get_gid() );
+  std::vector< latency_recorder* > instances;
+  std::vector< nest::Node* >::const_iterator sibling;
+  for ( sibling = siblings->begin(); sibling != siblings->end(); ++sibling )
+  {
+    instances.push_back( static_cast< latency_recorder* >( *sibling ) );
+  }
+
+  // the neurons are fixed when the first trial is evaluated
+  if ( B_.n_evaluated_ == 0 )
+  {
+    std::vector< long > neurons;
+    for ( size_t t = 0; t < instances.size(); ++t )
+    {
+      neurons.insert( neurons.end(),
+        instances[ t ]->B_.neurons_.begin(),
+        instances[ t ]->B_.neurons_.end() );
+    }
+    std::sort( neurons.begin(), neurons.end() );
+    neurons.erase(
+      std::unique( neurons.begin(), neurons.end() ), neurons.end() );
+    S_.set_neurons( neurons );
+  }
+
+  typedef std::map< long, std::map< long, Buffers_::Spikes_ > > Trials;
+  std::vector< double > latencies( S_.neurons_.size() );
+  std::vector< long > n_spikes( S_.neurons_.size() );
+  for ( long k = B_.n_evaluated_; k < n_complete; ++k )
+  {
+    std::fill( latencies.begin(),
+      latencies.end(),
+      std::numeric_limits< double >::quiet_NaN() );
+    std::fill( n_spikes.begin(), n_spikes.end(), 0 );
+    for ( size_t t = 0; t < instances.size(); ++t )
+    {
+      Trials& spikes = instances[ t ]->B_.spikes_;
+      const Trials::iterator trial = spikes.find( k );
+      if ( trial == spikes.end() )
+      {
+        continue;
+      }
+      std::map< long, Buffers_::Spikes_ >::const_iterator neuron;
+      for ( neuron = trial->second.begin(); neuron != trial->second.end();
+            ++neuron )
+      {
+        const size_t i = std::lower_bound( S_.neurons_.begin(),
+                           S_.neurons_.end(),
+                           neuron->first ) - S_.neurons_.begin();
+        latencies[ i ] =
+          nest::Time( nest::Time::step( neuron->second.first_ ) ).get_ms();
+        n_spikes[ i ] = neuron->second.n_;
+      }
+      spikes.erase( trial );
+    }
+    S_.add_trial( latencies, n_spikes );
+  }
+
+  for ( size_t t = 0; t < instances.size(); ++t )
+  {
+    instances[ t ]->B_.n_evaluated_ = n_complete;
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and event handling functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::latency_recorder::update( nest::Time const&, const long, const long )
+{
+  // the spikes are sorted into the trials as they arrive, see handle
+}
+
+void
+mynest::latency_recorder::handle( nest::SpikeEvent& e )
+{
+  if ( not device_.is_active( e.get_stamp() ) )
+  {
+    return;
+  }
+
+  const long rel = e.get_stamp().get_steps() - V_.onset_steps_;
+  if ( rel < 0 )
+  {
+    return;
+  }
+  const long trial = rel / V_.trial_steps_;
+  const long latency = rel % V_.trial_steps_;
+  if ( trial < B_.n_evaluated_ or latency >= V_.window_steps_ )
+  {
+    return;
+  }
+
+  // spikes of a slice arrive in any order, keep the earliest
+  std::map< long, Buffers_::Spikes_ >& spikes = B_.spikes_[ trial ];
+  const std::map< long, Buffers_::Spikes_ >::iterator neuron =
+    spikes.find( e.get_sender_gid() );
+  if ( neuron == spikes.end() )
+  {
+    Buffers_::Spikes_& first = spikes[ e.get_sender_gid() ];
+    first.first_ = latency;
+    first.n_ = e.get_multiplicity();
+  }
+  else
+  {
+    neuron->second.first_ = std::min( neuron->second.first_, latency );
+    neuron->second.n_ += e.get_multiplicity();
+  }
+}
@@ -0,0 +1,284 @@
+/*
+ *  latency_recorder.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LATENCY_RECORDER_H
+#define LATENCY_RECORDER_H
+
+// C++ includes:
+#include <map>
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "event.h"
+#include "exceptions.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: latency_recorder - Records first-spike latencies per trial.
+
+   Description:
+   The latency_recorder evaluates a trial-based protocol such as the MNSD
+   example, in which the order of the first spikes of some neurons in each
+   trial is the result of interest. Instead of the spikes, it keeps the
+   latency of the first spike of each connected neuron in each trial,
+   relative to the onset of the trial, and the statistics of the pairwise
+   latency differences over the trials in which both neurons fired.
+
+   Trial k starts at origin + start + k * trial_period, as for the
+   trial_dc_generator; spikes later than window after the onset are
+   ignored. A trial is evaluated at the end of the first Simulate call
+   after which all its spikes have been delivered, i.e. at least min_delay
+   after the end of its window. With a window shorter than trial_period
+   by at least min_delay, a trial is thus evaluated by the Simulate call
+   that plays it. The neurons must be connected before the first trial is
+   evaluated; trial_period and window can not be changed afterwards.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   trial_period  double - Trial length in ms
+   window        double - Part of each trial in which spikes count in ms,
+                          0 for the whole trial
+
+   The following parameters can be read out; arrays over pairs of neurons
+   are n x n matrices, flattened row by row, with n the number of neurons:
+
+   neurons     int array    - GIDs of the connected neurons, in increasing
+                              order
+   n_trials    int          - Number of trials evaluated
+   latencies   double array - First-spike latency of each neuron in each
+                              trial in ms, NaN if it did not fire; one row
+                              of n values per trial, rows flattened
+   n_spikes    int array    - Number of spikes of each neuron in the window
+                              of each trial, in the layout of latencies
+   n_detected  int array    - Number of neurons that fired, per trial
+   detections  int array    - Number of trials in which a neuron fired,
+                              per neuron
+   delta_n     int array    - Number of trials in which both neurons i
+                              and j fired, per pair (i, j)
+   delta_mean  double array - Mean of latency i - latency j over these
+                              trials, per pair (i, j)
+   delta_std   double array - Standard deviation of latency i - latency j
+                              over these trials, per pair (i, j)
+
+   Example:
+   First-spike order of four detectors, 300 trials of 1 s:
+
+   lat = nest.Create('latency_recorder', params={'trial_period': 1000.0,
+                                                 'window': 100.0})
+   nest.Connect(D1 + D2 + D3 + D4, lat)
+   nest.Simulate(300 * 1000.0)
+   latencies = nest.GetStatus(lat, 'latencies')[0].reshape(-1, 4)
+   single = nest.GetStatus(lat, 'n_spikes')[0].reshape(-1, 4) == 1
+
+   Receives: SpikeEvent
+
+   SeeAlso: trial_dc_generator, spike_detector
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device keeping the first-spike latency of each neuron in each trial.
+ *
+ * Each thread instance collects the first spikes of the neurons of its
+ * thread. The instance on thread 0 evaluates the complete trials of all
+ * instances at the end of each simulation.
+ */
+class latency_recorder : public nest::DeviceNode
+{
+
+public:
+  latency_recorder();
+  latency_recorder( const latency_recorder& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  //! Spikes are recorded on the thread of their sender
+  bool
+  local_receiver() const
+  {
+    return true;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  void handle( nest::SpikeEvent& );
+
+  nest::port handles_test_event( nest::SpikeEvent&, nest::rport );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+  void post_run_cleanup();
+
+  void update( nest::Time const&, const long, const long );
+
+  //! Move the complete trials of all thread instances into S_
+  void evaluate_();
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    double trial_period_; //!< Trial length in ms
+    double window_;       //!< Part of the trial evaluated in ms, 0 for all
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+
+    //! Set values from dictionary; evaluated if trials have been evaluated
+    void set( const DictionaryDatum&, bool evaluated );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Results of the evaluated trials, kept by the instance on thread 0.
+   */
+  struct State_
+  {
+    std::vector< long > neurons_;      //!< GIDs, in increasing order
+    std::vector< double > latencies_;  //!< Per trial and neuron, in ms
+    std::vector< long > n_spikes_;     //!< Per trial and neuron
+    std::vector< long > n_detected_;   //!< Per trial
+    std::vector< long > detections_;   //!< Per neuron
+    std::vector< long > delta_n_;      //!< Per pair
+    std::vector< double > delta_mean_; //!< Per pair
+    std::vector< double > delta_m2_;   //!< Sum of squared deviations
+
+    State_();
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+
+    //! Fix the neurons, before the first trial is added
+    void set_neurons( const std::vector< long >& );
+
+    //! Add a trial, with the latencies of the neurons, NaN if silent,
+    //! and their numbers of spikes
+    void add_trial( const std::vector< double >&, const std::vector< long >& );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Buffers of the model.
+   */
+  struct Buffers_
+  {
+    //! Spikes of one neuron in one trial
+    struct Spikes_
+    {
+      long first_; //!< latency of the first spike in steps
+      long n_;     //!< number of spikes
+    };
+
+    //! Neurons connected to this instance
+    std::vector< long > neurons_;
+    //! Spikes of each neuron in the trials not evaluated yet, by GID, by
+    //! trial
+    std::map< long, std::map< long, Spikes_ > > spikes_;
+    //! Number of trials evaluated; their spikes are ignored
+    long n_evaluated_;
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    long onset_steps_;  //!< Onset of trial 0
+    long trial_steps_;  //!< Trial length in steps
+    long window_steps_; //!< Evaluated part of a trial in steps
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  Parameters_ P_;
+  State_ S_;
+  Buffers_ B_;
+  Variables_ V_;
+};
+
+inline nest::port
+latency_recorder::handles_test_event( nest::SpikeEvent& e,
+  nest::rport receptor_type )
+{
+  if ( receptor_type != 0 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  if ( B_.n_evaluated_ > 0 )
+  {
+    throw nest::IllegalConnection( "latency_recorder: neurons must be "
+                                   "connected before trials are evaluated." );
+  }
+  B_.neurons_.push_back( e.get_sender().get_gid() );
+  return 0;
+}
+
+inline void
+latency_recorder::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_;              // temporary copy in case of errors
+  ptmp.set( d, B_.n_evaluated_ > 0 ); // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+}
+
+} // namespace mynest
+
+#endif // LATENCY_RECORDER_H
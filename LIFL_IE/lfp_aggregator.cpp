@@ -0,0 +1,267 @@
+/*
+ *  lfp_aggregator.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "lfp_aggregator.h"
+
+// C++ includes:
+#include <algorithm>
+#include <cmath>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "booldatum.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::lfp_aggregator::Parameters_::Parameters_()
+  : interval_( 1.0 )   // ms
+  , filter_tau_( 0.0 ) // ms
+  , to_memory_( true )
+{
+}
+
+mynest::lfp_aggregator::State_::State_()
+  : next_step_( 0 )
+  , filtered_( 0.0 )
+  , times_()
+  , signal_()
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::lfp_aggregator::Parameters_::get( DictionaryDatum& d ) const
+{
+  def< double >( d, nest::names::interval, interval_ );
+  def< double >( d, names::filter_tau, filter_tau_ );
+  def< bool >( d, nest::names::to_memory, to_memory_ );
+}
+
+void
+mynest::lfp_aggregator::Parameters_::set( const DictionaryDatum& d )
+{
+  updateValue< double >( d, nest::names::interval, interval_ );
+  updateValue< double >( d, names::filter_tau, filter_tau_ );
+  updateValue< bool >( d, nest::names::to_memory, to_memory_ );
+
+  if ( interval_ < nest::Time::get_resolution().get_ms() )
+  {
+    throw nest::BadProperty(
+      "interval must be at least the simulation resolution." );
+  }
+  if ( filter_tau_ < 0 )
+  {
+    throw nest::BadProperty( "filter_tau must not be negative." );
+  }
+}
+
+void
+mynest::lfp_aggregator::State_::get( DictionaryDatum& d ) const
+{
+  DictionaryDatum events( new Dictionary );
+  ( *events )[ nest::names::times ] =
+    DoubleVectorDatum( new std::vector< double >( times_ ) );
+  ( *events )[ names::signal ] =
+    DoubleVectorDatum( new std::vector< double >( signal_ ) );
+  ( *d )[ nest::names::events ] = events;
+  def< long >( d, nest::names::n_events, times_.size() );
+}
+
+void
+mynest::lfp_aggregator::State_::set( const DictionaryDatum& d )
+{
+  long n_events;
+  if ( updateValue< long >( d, nest::names::n_events, n_events ) )
+  {
+    if ( n_events != 0 )
+    {
+      throw nest::BadProperty( "n_events can only be set to 0." );
+    }
+    times_.clear();
+    signal_.clear();
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::lfp_aggregator::lfp_aggregator()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , S_()
+{
+}
+
+mynest::lfp_aggregator::lfp_aggregator( const lfp_aggregator& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , S_( n.S_ )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::lfp_aggregator::init_state_( const Node& proto )
+{
+  const lfp_aggregator& pr = downcast< lfp_aggregator >( proto );
+
+  device_.init_state( pr.device_ );
+  S_.filtered_ = 0.0;
+}
+
+void
+mynest::lfp_aggregator::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::lfp_aggregator::calibrate()
+{
+  device_.calibrate();
+
+  // neurons write the current slice while thread 0 reduces the previous one
+  const long min_delay = nest::kernel().connection_manager.get_min_delay();
+  B_.partial_.assign( 2 * min_delay, 0.0 );
+
+  const double h = nest::Time::get_resolution().get_ms();
+  V_.filter_prop_ = P_.filter_tau_ > 0 ? std::exp( -h / P_.filter_tau_ ) : 0.0;
+  V_.interval_steps_ =
+    nest::Time( nest::Time::ms( P_.interval_ ) ).get_steps();
+
+  S_.next_step_ = nest::kernel().simulation_manager.get_time().get_steps();
+
+  B_.siblings_.clear();
+  if ( get_thread() == 0 )
+  {
+    const nest::thread n_threads =
+      nest::kernel().vp_manager.get_num_threads();
+    for ( nest::thread t = 0; t < n_threads; ++t )
+    {
+      B_.siblings_.push_back( static_cast< lfp_aggregator* >(
+        nest::kernel().node_manager.get_node( get_gid(), t ) ) );
+    }
+  }
+}
+
+void
+mynest::lfp_aggregator::post_run_cleanup()
+{
+  if ( get_thread() == 0 )
+  {
+    reduce_( nest::kernel().simulation_manager.get_time().get_steps() );
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Consumers of the signal
+ * ---------------------------------------------------------------- */
+
+void
+mynest::lfp_aggregator::add_sink( SignalSink& sink )
+{
+  if ( std::find( sinks_.begin(), sinks_.end(), &sink ) == sinks_.end() )
+  {
+    sinks_.push_back( &sink );
+  }
+}
+
+void
+mynest::lfp_aggregator::remove_sink( SignalSink& sink )
+{
+  sinks_.erase(
+    std::remove( sinks_.begin(), sinks_.end(), &sink ), sinks_.end() );
+}
+
+/* ----------------------------------------------------------------
+ * Update and reduction functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::lfp_aggregator::update( nest::Time const& origin,
+  const long from,
+  const long )
+{
+  // all threads have finished the steps before this slice
+  if ( get_thread() == 0 )
+  {
+    reduce_( origin.get_steps() + from );
+  }
+}
+
+void
+mynest::lfp_aggregator::reduce_( const long end )
+{
+  const size_t buffer_size = B_.partial_.size();
+  for ( ; S_.next_step_ < end; ++S_.next_step_ )
+  {
+    const size_t i = S_.next_step_ % buffer_size;
+    double sum = 0.0;
+    for ( size_t t = 0; t < B_.siblings_.size(); ++t )
+    {
+      sum += B_.siblings_[ t ]->B_.partial_[ i ];
+      B_.siblings_[ t ]->B_.partial_[ i ] = 0.0;
+    }
+
+    S_.filtered_ =
+      V_.filter_prop_ * S_.filtered_ + ( 1.0 - V_.filter_prop_ ) * sum;
+
+    // the currents after the update of a step belong to the next step
+    const long stamp = S_.next_step_ + 1;
+    if ( stamp % V_.interval_steps_ == 0
+      and device_.is_active( nest::Time::step( stamp ) ) )
+    {
+      const double t = nest::Time( nest::Time::step( stamp ) ).get_ms();
+      if ( P_.to_memory_ )
+      {
+        S_.times_.push_back( t );
+        S_.signal_.push_back( S_.filtered_ );
+      }
+      for ( size_t k = 0; k < sinks_.size(); ++k )
+      {
+        sinks_[ k ]->receive_sample( t, S_.filtered_ );
+      }
+    }
+  }
+}
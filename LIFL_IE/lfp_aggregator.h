@@ -0,0 +1,320 @@
+/*
+ *  lfp_aggregator.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LFP_AGGREGATOR_H
+#define LFP_AGGREGATOR_H
+
+// C++ includes:
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "nest_time.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: lfp_aggregator - Records the weighted sum of synaptic currents.
+
+   Description:
+   The lfp_aggregator records an LFP/MEG proxy, the weighted sum of the
+   synaptic currents of many neurons, without recording the neurons
+   individually. Each connected lifl_psc_exp_ie or aeif_psc_exp_peak adds
+
+     weight_ex * I_syn_ex + weight_in * I_syn_in
+
+   to the aggregator in every step of its update, with I_syn_ex and
+   I_syn_in as recorded by a multimeter. Only the aggregate signal is
+   stored.
+
+   The neurons add to a partial sum of the aggregator instance on their
+   own thread. The partial sums of a min-delay slice are reduced in the
+   next slice, when all threads have finished it, by the instance on
+   thread 0; the remaining steps are reduced at the end of Simulate. The
+   summed signal can be low-pass filtered (first order, time constant
+   filter_tau) before it is sampled every interval. With several MPI
+   processes, each process records the sum over its local neurons.
+
+   The samples are also passed on, as they are recorded, to devices that
+   consume the signal, such as meg_comparator.
+
+   Neurons are connected with ConnectAggregator, not with Connect.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   interval    double - Sampling interval in ms
+   filter_tau  double - Time constant of the low-pass filter in ms, 0 to
+                        sample the sum unfiltered
+   to_memory   bool   - Store the samples; false if they are only
+                        consumed by other devices
+   events      dict   - Recorded signal: times (ms) and signal
+   n_events    int    - Number of samples recorded, set to 0 to clear
+
+   Example:
+   LFP proxy of a column, weighted by dendrite length:
+
+   lfp = nest.Create('lfp_aggregator', 1, {'interval': 0.1})
+   nest.sli_func('ConnectAggregator', lfp[0], list(Pyr23), 0.000482, 0.0)
+   nest.sli_func('ConnectAggregator', lfp[0], list(Pyr5), 0.001342, 0.0)
+   nest.Simulate(500.0)
+   signal = nest.GetStatus(lfp, 'events')[0]['signal']
+
+   SeeAlso: ConnectAggregator, meg_comparator, multimeter
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Interface of devices consuming the samples of an lfp_aggregator while
+ * they are recorded.
+ */
+class SignalSink
+{
+public:
+  virtual ~SignalSink()
+  {
+  }
+
+  //! Called on thread 0 for each sample, in the order of time
+  virtual void receive_sample( double t, double value ) = 0;
+};
+
+/**
+ * Device summing the weighted synaptic currents of connected neurons.
+ */
+class lfp_aggregator : public nest::DeviceNode
+{
+
+public:
+  lfp_aggregator();
+  lfp_aggregator( const lfp_aggregator& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  /**
+   * Add the contribution of a neuron in the step following step. Must only
+   * be called by neurons updated on the thread of this instance.
+   */
+  void
+  add( const long step, const double value )
+  {
+    B_.partial_[ step % B_.partial_.size() ] += value;
+  }
+
+  //! Pass the samples of this aggregator to sink; on thread 0 only
+  void add_sink( SignalSink& );
+  void remove_sink( SignalSink& );
+
+  //! Time in ms up to which the samples have been passed to the sinks
+  double
+  sampled_until() const
+  {
+    return nest::Time( nest::Time::step( S_.next_step_ ) ).get_ms();
+  }
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+  void post_run_cleanup();
+
+  void update( nest::Time const&, const long, const long );
+
+  //! Sum the partial sums of all threads up to step end, filter and sample
+  void reduce_( const long end );
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    double interval_;   //!< Sampling interval in ms
+    double filter_tau_; //!< Low-pass time constant in ms, 0 for none
+    bool to_memory_;    //!< Store the samples
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+    void set( const DictionaryDatum& ); //!< Set values from dictionary
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * State variables of the model, only used on thread 0.
+   */
+  struct State_
+  {
+    long next_step_;               //!< First step not yet reduced
+    double filtered_;              //!< Output of the low-pass filter
+    std::vector< double > times_;  //!< Sample times in ms
+    std::vector< double > signal_; //!< Samples
+
+    State_(); //!< Default initialization
+
+    void get( DictionaryDatum& ) const;
+    void set( const DictionaryDatum& );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Buffers of the model.
+   */
+  struct Buffers_
+  {
+    //! Partial sums of this thread, indexed by step modulo two slices
+    std::vector< double > partial_;
+
+    //! Instances of this aggregator on all threads, only on thread 0
+    std::vector< lfp_aggregator* > siblings_;
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    double filter_prop_;  //!< Propagator of the low-pass filter
+    long interval_steps_; //!< Sampling interval in steps
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  Parameters_ P_;
+  State_ S_;
+  Buffers_ B_;
+  Variables_ V_;
+
+  //! Consumers of the samples, such as meg_comparator
+  std::vector< SignalSink* > sinks_;
+};
+
+inline void
+lfp_aggregator::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+
+  // the signal is recorded by the instance on thread 0 only
+  if ( get_thread() == 0 )
+  {
+    S_.get( d );
+  }
+}
+
+inline void
+lfp_aggregator::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_; // temporary copy in case of errors
+  ptmp.set( d );         // throws if BadProperty
+  State_ stmp = S_;
+  stmp.set( d );
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+  S_ = stmp;
+}
+
+/**
+ * Aggregators a neuron contributes to, with the weights of its currents.
+ */
+class AggregatorTargets
+{
+public:
+  void
+  add( lfp_aggregator& aggregator, double weight_ex, double weight_in )
+  {
+    const Target_ t = { &aggregator, weight_ex, weight_in };
+    targets_.push_back( t );
+  }
+
+  bool
+  empty() const
+  {
+    return targets_.empty();
+  }
+
+  //! Add the currents after the update of step to all aggregators
+  void
+  record( const long step, const double I_syn_ex, const double I_syn_in )
+  {
+    for ( size_t k = 0; k < targets_.size(); ++k )
+    {
+      targets_[ k ].aggregator->add( step,
+        targets_[ k ].weight_ex * I_syn_ex
+          + targets_[ k ].weight_in * I_syn_in );
+    }
+  }
+
+private:
+  struct Target_
+  {
+    lfp_aggregator* aggregator;
+    double weight_ex;
+    double weight_in;
+  };
+
+  std::vector< Target_ > targets_;
+};
+
+/**
+ * Interface implemented by models that can be connected to an
+ * lfp_aggregator.
+ */
+class AggregatorSource
+{
+public:
+  virtual ~AggregatorSource()
+  {
+  }
+
+  //! Add the weighted synaptic currents of the node to the aggregator
+  virtual void connect_aggregator( lfp_aggregator&, double, double ) = 0;
+};
+
+} // namespace mynest
+
+#endif // LFP_AGGREGATOR_H
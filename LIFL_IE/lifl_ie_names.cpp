@@ -0,0 +1,99 @@
+/*
+ *  lifl_ie_names.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "lifl_ie_names.h"
+
+namespace mynest
+{
+namespace names
+{
+const Name amplitudes( "amplitudes" );
+const Name baseline( "baseline" );
+const Name best_correlation( "best_correlation" );
+const Name best_lag( "best_lag" );
+const Name bg_rate( "bg_rate" );
+const Name bg_weight( "bg_weight" );
+const Name block_spikes( "block_spikes" );
+const Name capacity( "capacity" );
+const Name channel( "channel" );
+const Name chunk_rows( "chunk_rows" );
+const Name columns( "columns" );
+const Name condition( "condition" );
+const Name conn_spec( "conn_spec" );
+const Name correlation( "correlation" );
+const Name delta( "delta" );
+const Name delta_mean( "delta_mean" );
+const Name delta_n( "delta_n" );
+const Name delta_std( "delta_std" );
+const Name detections( "detections" );
+const Name durations( "durations" );
+const Name filename( "filename" );
+const Name filter_tau( "filter_tau" );
+const Name ie_grid( "ie_grid" );
+const Name inputs( "inputs" );
+const Name lags( "lags" );
+const Name latencies( "latencies" );
+const Name max_lag( "max_lag" );
+const Name n_channels( "n_channels" );
+const Name n_detected( "n_detected" );
+const Name n_dropped( "n_dropped" );
+const Name n_played( "n_played" );
+const Name n_samples( "n_samples" );
+const Name n_spikes( "n_spikes" );
+const Name n_trials( "n_trials" );
+const Name name( "name" );
+const Name neurons( "neurons" );
+const Name noise( "noise" );
+const Name onsets( "onsets" );
+const Name orientation( "orientation" );
+const Name params( "params" );
+const Name per_node( "per_node" );
+const Name periodic( "periodic" );
+const Name permutations( "permutations" );
+const Name population( "population" );
+const Name populations( "populations" );
+const Name projections( "projections" );
+const Name record_period( "record_period" );
+const Name record_windows( "record_windows" );
+const Name reference( "reference" );
+const Name reference_interval( "reference_interval" );
+const Name rmse( "rmse" );
+const Name rows( "rows" );
+const Name scale( "scale" );
+const Name seed( "seed" );
+const Name shm_name( "shm_name" );
+const Name sigma( "sigma" );
+const Name signal( "signal" );
+const Name source( "source" );
+const Name spatial_frequency( "spatial_frequency" );
+const Name stencil( "stencil" );
+const Name syn_spec( "syn_spec" );
+const Name target( "target" );
+const Name targets( "targets" );
+const Name tile( "tile" );
+const Name trial_period( "trial_period" );
+const Name trial_reset_V( "trial_reset_V" );
+const Name V_m_range( "V_m_range" );
+const Name window( "window" );
+const Name xcorr( "xcorr" );
+}
+}
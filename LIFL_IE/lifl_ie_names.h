@@ -0,0 +1,113 @@
+/*
+ *  lifl_ie_names.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIFL_IE_NAMES_H
+#define LIFL_IE_NAMES_H
+
+// Includes from sli:
+#include "name.h"
+
+namespace mynest
+{
+
+/**
+ * This namespace contains global Name objects of the LIFL_IE module.
+ * Names that are already used by the NEST kernel are taken from
+ * nest::names; the ones here are specific to this module.
+ *
+ * The Names are declared here and defined in lifl_ie_names.cpp.
+ */
+namespace names
+{
+extern const Name amplitudes;
+extern const Name baseline;
+extern const Name best_correlation;
+extern const Name best_lag;
+extern const Name bg_rate;
+extern const Name bg_weight;
+extern const Name block_spikes;
+extern const Name capacity;
+extern const Name channel;
+extern const Name chunk_rows;
+extern const Name columns;
+extern const Name condition;
+extern const Name conn_spec;
+extern const Name correlation;
+extern const Name delta;
+extern const Name delta_mean;
+extern const Name delta_n;
+extern const Name delta_std;
+extern const Name detections;
+extern const Name durations;
+extern const Name filename;
+extern const Name filter_tau;
+extern const Name ie_grid;
+extern const Name inputs;
+extern const Name lags;
+extern const Name latencies;
+extern const Name max_lag;
+extern const Name n_channels;
+extern const Name n_detected;
+extern const Name n_dropped;
+extern const Name n_played;
+extern const Name n_samples;
+extern const Name n_spikes;
+extern const Name n_trials;
+extern const Name name;
+extern const Name neurons;
+extern const Name noise;
+extern const Name onsets;
+extern const Name orientation;
+extern const Name params;
+extern const Name per_node;
+extern const Name periodic;
+extern const Name permutations;
+extern const Name population;
+extern const Name populations;
+extern const Name projections;
+extern const Name record_period;
+extern const Name record_windows;
+extern const Name reference;
+extern const Name reference_interval;
+extern const Name rmse;
+extern const Name rows;
+extern const Name scale;
+extern const Name seed;
+extern const Name shm_name;
+extern const Name sigma;
+extern const Name signal;
+extern const Name source;
+extern const Name spatial_frequency;
+extern const Name stencil;
+extern const Name syn_spec;
+extern const Name target;
+extern const Name targets;
+extern const Name tile;
+extern const Name trial_period;
+extern const Name trial_reset_V;
+extern const Name V_m_range;
+extern const Name window;
+extern const Name xcorr;
+}
+}
+
+#endif // LIFL_IE_NAMES_H
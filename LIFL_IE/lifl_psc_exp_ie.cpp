@@ -36,7 +36,6 @@
 #include "event_delivery_manager_impl.h"
 #include "exceptions.h"
 #include "kernel_manager.h"
-#include "universal_data_logger_impl.h"
 
 #include "histentry.h"
 #include "node.h"
@@ -54,6 +53,9 @@
 #include "integerdatum.h"
 #include "lockptrdatum.h"
 
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
 /* ----------------------------------------------------------------
  * Recordables map
  * ---------------------------------------------------------------- */
@@ -94,27 +96,29 @@ mynest::lifl_psc_exp_ie::Parameters_::Parameters_()
   , tau_in_( 2.0 )           // in ms
 
   // Latency and Intrinsic excitability 
-  , dt( 0.0 )    // ms Parameter of time resolution
   , lambda(0.0001) // Lambda - Intrinsic Plasticity enhance
   , tau(12.5) // Tau - Intrinsic Plasticity window
   , std_mod(true) // ON/OFF of the spike time dependent modification
   , stimulator_()
+  , trial_period_( 0.0 )  // ms, no trial resets
+  , trial_reset_V_( 0.0 ) // relative E_L_
+  , bg_rate_( 0.0 )       // spikes/s, no background input
+  , bg_weight_( 0.0 )     // pA
 
 {
 }
 
 mynest::lifl_psc_exp_ie::State_::State_()
-  : i_0_( 0.0 )
+  : V_m_( 0.0 )
   , i_syn_ex_( 0.0 )
   , i_syn_in_( 0.0 )
-  , V_m_( 0.0 )
-  , r_ref_( 0 )
+  , i_0_( 0.0 )
+  , i_1_( 0.0 )
 
   // Latency and Intrinsic excitability 
-  //, refr_count( 0 )
   , enhancement(1.0)
-  , t_lastspike_()
-  , hist_(0.0)
+  , Vpositive( 0.0 )
+  , r_ref_( 0 )
 {
 }
 
@@ -150,6 +154,11 @@ for ( size_t n = 0; n < n_stims; ++n)
 
 (*d )[ nest::names::stimulator] = IntVectorDatum( stims );
 
+  def< double >( d, names::trial_period, trial_period_ );
+  def< double >( d, names::trial_reset_V, trial_reset_V_ + E_L_ );
+  def< double >( d, names::bg_rate, bg_rate_ );
+  def< double >( d, names::bg_weight, bg_weight_ );
+  record_gate_.get( d );
 }
 
 double
@@ -192,6 +201,19 @@ mynest::lifl_psc_exp_ie::Parameters_::set( const DictionaryDatum& d )
   updateValue< std::vector< long > >( d, nest::names::stimulator, stimulator_ );
   updateValue< bool >(d,nest::names::std_mod, std_mod );
 
+  updateValue< double >( d, names::trial_period, trial_period_ );
+  if ( updateValue< double >( d, names::trial_reset_V, trial_reset_V_ ) )
+  {
+    trial_reset_V_ -= E_L_;
+  }
+  else
+  {
+    trial_reset_V_ -= delta_EL;
+  }
+
+  updateValue< double >( d, names::bg_rate, bg_rate_ );
+  updateValue< double >( d, names::bg_weight, bg_weight_ );
+  record_gate_.set( d );
 
   if ( V_reset_ >= Theta_ )
   {
@@ -210,10 +232,45 @@ mynest::lifl_psc_exp_ie::Parameters_::set( const DictionaryDatum& d )
   {
     throw nest::BadProperty( "Refractory time must not be negative." );
   }
+  if ( trial_period_ < 0 )
+  {
+    throw nest::BadProperty( "Trial period must not be negative." );
+  }
+  if ( bg_rate_ < 0 )
+  {
+    throw nest::BadProperty( "Background rate must not be negative." );
+  }
 
   return delta_EL;
 }
 
+bool
+mynest::lifl_psc_exp_ie::Parameters_::same_as( const Parameters_& p ) const
+{
+  return Tau_ == p.Tau_ && C_ == p.C_ && t_ref_ == p.t_ref_ && E_L_ == p.E_L_
+    && I_e_ == p.I_e_ && Theta_ == p.Theta_ && V_reset_ == p.V_reset_
+    && tau_ex_ == p.tau_ex_ && tau_in_ == p.tau_in_
+    && stimulator_ == p.stimulator_ && lambda == p.lambda && tau == p.tau
+    && std_mod == p.std_mod && trial_period_ == p.trial_period_
+    && trial_reset_V_ == p.trial_reset_V_ && bg_rate_ == p.bg_rate_
+    && bg_weight_ == p.bg_weight_ && record_gate_ == p.record_gate_;
+}
+
+mynest::lifl_psc_exp_ie::SharedParameters_::SharedParameters_(
+  const Parameters_& p )
+  : Parameters_( p )
+  , P20_( 0.0 )
+  , P11ex_( 0.0 )
+  , P11in_( 0.0 )
+  , P21ex_( 0.0 )
+  , P21in_( 0.0 )
+  , P22_( 0.0 )
+  , RefractoryCounts_( 0 )
+  , TrialSteps_( 0 )
+  , h_( 0.0 )
+{
+}
+
 
 
 void
@@ -239,6 +296,18 @@ mynest::lifl_psc_exp_ie::State_::set( const DictionaryDatum& d,
   updateValue< double >( d, nest::names::soma_exc, enhancement );
 }
 
+void
+mynest::lifl_psc_exp_ie::set_stimulators( const std::vector< long >& stims )
+{
+  if ( stims == P_->stimulator_ )
+  {
+    return;
+  }
+  Parameters_ ptmp = *P_;
+  ptmp.stimulator_ = stims;
+  P_ = std::make_shared< SharedParameters_ >( ptmp );
+}
+
 mynest::lifl_psc_exp_ie::Buffers_::Buffers_( lifl_psc_exp_ie& n )
   : logger_( n )
 {
@@ -255,18 +324,22 @@ mynest::lifl_psc_exp_ie::Buffers_::Buffers_( const Buffers_&, lifl_psc_exp_ie& n
 
 mynest::lifl_psc_exp_ie::lifl_psc_exp_ie()
   : Archiving_Node()
-  , P_()
   , S_()
+  , V_()
+  , P_( std::make_shared< SharedParameters_ >( Parameters_() ) )
   , B_( *this )
+  , ie_( new IEHistory_() )
 {
   recordablesMap_.create();
 }
 
 mynest::lifl_psc_exp_ie::lifl_psc_exp_ie( const lifl_psc_exp_ie& n )
   : Archiving_Node( n )
-  , P_( n.P_ )
   , S_( n.S_ )
+  , V_()
+  , P_( n.P_ )
   , B_( n.B_, *this )
+  , ie_( new IEHistory_( *n.ie_ ) )
 {
 }
 
@@ -279,28 +352,51 @@ mynest::lifl_psc_exp_ie::init_state_( const Node& proto )
 {
   const lifl_psc_exp_ie& pr = downcast< lifl_psc_exp_ie >( proto );
   S_ = pr.S_;
+  *ie_ = *pr.ie_;
 }
 
 void
 mynest::lifl_psc_exp_ie::init_buffers_()
 {
-  B_.spikes_ex_.clear(); // includes resize
-  B_.spikes_in_.clear(); // includes resize
-  B_.currents_.clear();  // includes resize
+  B_.input_.clear(); // includes resize
   B_.logger_.reset();
  /// Archiving_Node::clear_history_();
+
+  // pending input restored from a checkpoint before the first Simulate
+  if ( ckpt_.has_deferred_buffers() )
+  {
+    CheckpointBuffer b = ckpt_.take_deferred_buffers();
+    restore_buffers_( b );
+  }
+  ckpt_.set_buffers_ready();
 }
 
 void
 mynest::lifl_psc_exp_ie::calibrate()
 {
-  B_.currents_.resize( 2 );
   // ensures initialization in case mm connected after Simulate
-  B_.logger_.init();
+  B_.logger_.init( P_->record_gate_ );
 
-  const double h = nest::Time::get_resolution().get_ms();
+  // one last-spike time per modulator; keeps existing entries
+  ie_->t_lastspike_.resize( P_->stimulator_.size(), 0.0 );
+  prune_ie_history_(); // the removed modulators may have held it
 
-  P_.dt = h;      // We save resolution for further calculations.
+  P_->calibrate( nest::Time::get_resolution().get_ms() );
+
+  B_.bg_dev_.set_lambda( P_->bg_rate_ * P_->h_ * 1e-3 );
+}
+
+void
+mynest::lifl_psc_exp_ie::SharedParameters_::calibrate( double h )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  // propagators are computed once for all nodes sharing them, not on every
+  // call of Simulate
+  if ( h_ == h )
+  {
+    return;
+  }
 
   // numbering of state vaiables: i_0 = 0, i_syn_ = 1, V_m_ = 2
 
@@ -308,23 +404,23 @@ mynest::lifl_psc_exp_ie::calibrate()
   // needed to exactly reproduce Tsodyks network
 
   // these P are independent
-  V_.P11ex_ = std::exp( -h / P_.tau_ex_ );
+  P11ex_ = std::exp( -h / tau_ex_ );
   // P11ex_ = 1.0-h/tau_ex_;
 
-  V_.P11in_ = std::exp( -h / P_.tau_in_ );
+  P11in_ = std::exp( -h / tau_in_ );
   // P11in_ = 1.0-h/tau_in_;
 
-  V_.P22_ = std::exp( -h / P_.Tau_ );
+  P22_ = std::exp( -h / Tau_ );
   // P22_ = 1.0-h/Tau_;
 
   // these are determined according to a numeric stability criterion
-  V_.P21ex_ = propagator_32( P_.tau_ex_, P_.Tau_, P_.C_, h );
-  V_.P21in_ = propagator_32( P_.tau_in_, P_.Tau_, P_.C_, h );
+  P21ex_ = propagator_32( tau_ex_, Tau_, C_, h );
+  P21in_ = propagator_32( tau_in_, Tau_, C_, h );
 
   // P21ex_ = h/C_;
   // P21in_ = h/C_;
 
-  V_.P20_ = P_.Tau_ / P_.C_ * ( 1.0 - V_.P22_ );
+  P20_ = Tau_ / C_ * ( 1.0 - P22_ );
   // P20_ = h/C_;
 
   // t_ref_ specifies the length of the absolute refractory period as
@@ -344,29 +440,41 @@ mynest::lifl_psc_exp_ie::calibrate()
   // results. However, a neuron model capable of operating with real valued
   // spike time may exhibit a different effective refractory time.
 
-  V_.RefractoryCounts_ = nest::Time( nest::Time::ms( P_.t_ref_ ) ).get_steps();
+  RefractoryCounts_ = nest::Time( nest::Time::ms( t_ref_ ) ).get_steps();
   // since t_ref_ >= 0, this can only fail in error
-  assert( V_.RefractoryCounts_ >= 0 );
+  assert( RefractoryCounts_ >= 0 );
 
-  // INITIALIZATIONS
-  const size_t n_stims = P_.stimulator_.size();
-  for(size_t i = 0; i < n_stims; i++)
-  {
-   S_.t_lastspike_.push_back(0.0);
-  }
+  TrialSteps_ = nest::Time( nest::Time::ms( trial_period_ ) ).get_steps();
 
+  h_ = h;
 }
 
 void
 mynest::lifl_psc_exp_ie::update( const nest::Time& origin, const long from, const long to )
+{
+  update_< true, true >( origin, from, to );
+}
+
+template < bool ie, bool filtered_current >
+void
+mynest::lifl_psc_exp_ie::update_( const nest::Time& origin, const long from, const long to )
 {
   assert(
     to >= 0 && ( nest::delay ) from < nest::kernel().connection_manager.get_min_delay() );
   assert( from < to );
 
+  librandom::RngPtr rng = nest::kernel().rng_manager.get_rng( get_thread() );
+
   // evolve from timestep 'from' to timestep 'to' with steps of h each
   for ( long lag = from; lag < to; ++lag )
   {
+    // trial boundaries are multiples of the trial period after time 0
+    const long step = origin.get_steps() + lag;
+    if ( P_->TrialSteps_ > 0 && step > 0 && step % P_->TrialSteps_ == 0 )
+    {
+      reset_trial_();
+    }
+
      if (S_.V_m_ >= 105.0)
      {
      S_.V_m_ = 105.0;
@@ -374,9 +482,12 @@ mynest::lifl_psc_exp_ie::update( const nest::Time& origin, const long from, cons
      set_spiketime( nest::Time::step( origin.get_steps() + lag + 1 ) );
      nest::SpikeEvent se;
      nest::kernel().event_delivery_manager.send( *this, se, lag );
-     S_.r_ref_ = V_.RefractoryCounts_;
+     S_.r_ref_ = P_->RefractoryCounts_;
 
-     S_.hist_.push_back(nest::Archiving_Node::get_spiketime_ms());
+     if ( ie )
+     {
+       record_ie_spike_( origin.get_steps() + lag + 1 );
+     }
 
      }
 
@@ -387,7 +498,7 @@ mynest::lifl_psc_exp_ie::update( const nest::Time& origin, const long from, cons
       if (S_.V_m_ > 15.6) // 15.6 is the value calculated for this specific SpikeLatency
       {
         S_.Vpositive = S_.V_m_ / 15;	
-      	S_.V_m_ = S_.V_m_ + (pow((S_.Vpositive-1),2)*P_.dt)/(1-(S_.Vpositive - 1)*P_.dt) * 15;
+      	S_.V_m_ = S_.V_m_ + (pow((S_.Vpositive-1),2)*P_->h_)/(1-(S_.Vpositive - 1)*P_->h_) * 15;
 
       if (S_.V_m_ >= 105.0)
       {
@@ -396,16 +507,19 @@ mynest::lifl_psc_exp_ie::update( const nest::Time& origin, const long from, cons
       set_spiketime( nest::Time::step( origin.get_steps() + lag + 1 ) );
       nest::SpikeEvent se;
       nest::kernel().event_delivery_manager.send( *this, se, lag );
-      S_.r_ref_ = V_.RefractoryCounts_;
+      S_.r_ref_ = P_->RefractoryCounts_;
 
-      S_.hist_.push_back(lag);
+      if ( ie )
+      {
+        record_ie_spike_( origin.get_steps() + lag + 1 );
+      }
       }
 
       }
       else
       {
-        S_.V_m_ = S_.V_m_ * V_.P22_ + S_.i_syn_in_ * V_.P21in_ 
-          + (S_.i_syn_ex_ * V_.P21ex_ + ( P_.I_e_ + S_.i_0_ ) * V_.P20_) * S_.enhancement; // Compute V_m of neuron
+        S_.V_m_ = S_.V_m_ * P_->P22_ + S_.i_syn_in_ * P_->P21in_ 
+          + (S_.i_syn_ex_ * P_->P21ex_ + ( P_->I_e_ + S_.i_0_ ) * P_->P20_) * S_.enhancement; // Compute V_m of neuron
       }
     }
     else
@@ -416,101 +530,165 @@ mynest::lifl_psc_exp_ie::update( const nest::Time& origin, const long from, cons
     } // neuron is absolute refractory
 
     // exponential decaying PSCs
-    S_.i_syn_ex_ *= V_.P11ex_;
-    S_.i_syn_in_ *= V_.P11in_;
+    S_.i_syn_ex_ *= P_->P11ex_;
+    S_.i_syn_in_ *= P_->P11in_;
 
     // add evolution of presynaptic input current
-    S_.i_syn_ex_ += ( 1. - V_.P11ex_ ) * S_.i_1_;
+    if ( filtered_current )
+    {
+      S_.i_syn_ex_ += ( 1. - P_->P11ex_ ) * S_.i_1_;
+    }
 
     // the spikes arriving at T+1 have an immediate effect on the state of the
     // neuron
 
-    V_.weighted_spikes_ex_ = B_.spikes_ex_.get_value( lag );
-    V_.weighted_spikes_in_ = B_.spikes_in_.get_value( lag );
+    const Buffers_::Input::Channels input = B_.input_.get_values( lag );
+
+    V_.weighted_spikes_ex_ = input[ Buffers_::SPIKES_EX ];
+    V_.weighted_spikes_in_ = input[ Buffers_::SPIKES_IN ];
 
     S_.i_syn_ex_ += V_.weighted_spikes_ex_;
     S_.i_syn_in_ += V_.weighted_spikes_in_;
 
+    // background input, added like the spikes of a poisson_generator
+    if ( P_->bg_rate_ > 0.0 )
+    {
+      const double bg = P_->bg_weight_ * B_.bg_dev_.ldev( rng );
+      if ( bg >= 0.0 )
+      {
+        S_.i_syn_ex_ += bg;
+      }
+      else
+      {
+        S_.i_syn_in_ += bg;
+      }
+    }
+
     // set new input current
-    S_.i_0_ = B_.currents_[ 0 ].get_value( lag );
-    S_.i_1_ = B_.currents_[ 1 ].get_value( lag );
+    S_.i_0_ = input[ Buffers_::CURRENT_0 ];
+    S_.i_1_ = input[ Buffers_::CURRENT_1 ];
 
     // log state data
     B_.logger_.record_data( origin.get_steps() + lag );
+    if ( not aggregators_.empty() )
+    {
+      aggregators_.record(
+        origin.get_steps() + lag, S_.i_syn_ex_, S_.i_syn_in_ );
+    }
   }
 }
 
+void
+mynest::lifl_psc_exp_ie::reset_trial_()
+{
+  // IE plasticity state (enhancement, spike history) is kept across trials
+  S_.V_m_ = P_->trial_reset_V_;
+  S_.Vpositive = 0.0;
+  S_.i_syn_ex_ = 0.0;
+  S_.i_syn_in_ = 0.0;
+  S_.r_ref_ = 0;
+}
+
 void
 mynest::lifl_psc_exp_ie::handle( nest::SpikeEvent& e )
+{
+  handle_spike_< true >( e );
+}
+
+template < bool ie >
+void
+mynest::lifl_psc_exp_ie::handle_spike_( nest::SpikeEvent& e )
 {
   assert( e.get_delay_steps() > 0 );
 
-  if ( e.get_weight() >= 0.0 )
-  {
-    B_.spikes_ex_.add_value( e.get_rel_delivery_steps(
-                               nest::kernel().simulation_manager.get_slice_origin() ),
-      e.get_weight() * e.get_multiplicity() );
-  }
-  else
-  {
-    B_.spikes_in_.add_value( e.get_rel_delivery_steps(
-                               nest::kernel().simulation_manager.get_slice_origin() ),
-      e.get_weight() * e.get_multiplicity() );
-  }
+  B_.input_.add_value( e.get_rel_delivery_steps(
+                         nest::kernel().simulation_manager.get_slice_origin() ),
+    e.get_weight() >= 0.0 ? Buffers_::SPIKES_EX : Buffers_::SPIKES_IN,
+    e.get_weight() * e.get_multiplicity() );
 
 
 
 
 
 
-  if (P_.std_mod)   // Implementing INTRINSIC EXCITABILITY (IE) Plasticity
+  if (ie && P_->std_mod)   // Implementing INTRINSIC EXCITABILITY (IE) Plasticity
   {
-    size_t origSize = P_.stimulator_.size();
+    size_t origSize = P_->stimulator_.size();
     
     for (size_t i=0; i < origSize; i++)
     {
-      long modulator = P_.stimulator_[ i ];
+      long modulator = P_->stimulator_[ i ];
       long source_gid = e.get_sender_gid();
 
       if (source_gid == modulator) // If gID of input current is from an Stimulator (IE modulator)
       {
 
-  // For a new synapse, t_lastspike_ contains the point in time of the last
-  // spike. So we initially read the
-  // history(t_last_spike - dendritic_delay, ..., T_spike-dendritic_delay]
-  // which increases the access counter for these entries.
-  // At registration, all entries' access counters of
-  // history[0, ..., t_last_spike - dendritic_delay] have been
-  // incremented by Archiving_Node::register_stdp_connection(). See bug #218 for
-  // details.
-  //target->get_history( 0.0, t_spike, &start, &finish );
-
-
-	double t_spike = e.get_stamp().get_ms(); 
-
-	size_t histsize = S_.hist_.size();
+	const double t_spike = e.get_stamp().get_ms();
+	const double enhancement = S_.enhancement;
 
+	// Take own spikes since the last spike of this modulator (history)
+	// and compute the LTP-IE or LTD-IE Plasticity changes
+	const long last_step =
+	  nest::Time( nest::Time::ms( ie_->t_lastspike_[ i ] ) ).get_steps();
+	for ( IEHistory_::History::const_iterator r = std::upper_bound(
+	        ie_->hist_.begin(), ie_->hist_.end(), last_step );
+	      r != ie_->hist_.end();
+	      ++r )
+	{
+	  const double t_hist = nest::Time( nest::Time::step( *r ) ).get_ms();
 
- 	// Take last spikes (history) and compute the LTP-IE or LTD-IE Plasticity changes
+	  S_.enhancement += std::exp( ( ie_->t_lastspike_[ i ] - t_hist ) / P_->tau ) * P_->lambda;
 
-	long lstspk = S_.t_lastspike_[i];
-	auto r = std::find_if(std::begin(S_.hist_), std::end(S_.hist_), [lstspk](int its){return its > lstspk;});
-	while (r != std::end(S_.hist_)){ 
-
-		S_.enhancement = S_.enhancement + std::exp(((S_.t_lastspike_[i]) - S_.hist_[std::distance(std::begin(S_.hist_), r)] )/P_.tau)*P_.lambda;
+	  S_.enhancement -= std::exp( ( t_hist - t_spike ) / P_->tau ) * P_->lambda;
+	}
 
-		S_.enhancement = S_.enhancement - std::exp((S_.hist_[std::distance(std::begin(S_.hist_), r)]  - t_spike)/P_.tau)*P_.lambda;
+	ie_->t_lastspike_[i] = t_spike; // Save the last spike of this neuron for next occasion
 
-		r = std::find_if(std::next(r), std::end(S_.hist_), [lstspk](int its){return its > lstspk;});
+	// only a new modulator spike can make history entries prunable
+	prune_ie_history_();
 
+	if ( S_.enhancement != enhancement )
+	{
+	  for ( size_t k = 0; k < ie_recorders_.size(); ++k )
+	  {
+	    ie_recorders_[ k ]->record( get_gid(), t_spike, S_.enhancement,
+	      S_.enhancement - enhancement );
+	  }
 	}
-
-	S_.t_lastspike_[i] = t_spike; // Save the last spike of this neuron for next occasion
       }    
     }  
   }
 }
 
+void
+mynest::lifl_psc_exp_ie::record_ie_spike_( const long step )
+{
+  // only the IE plasticity reads this history; STDP synapses read the
+  // Archiving_Node history filled by set_spiketime(); without
+  // modulators, nothing would ever prune it
+  if ( P_->std_mod and not ie_->t_lastspike_.empty() )
+  {
+    ie_->hist_.push_back( step );
+  }
+}
+
+void
+mynest::lifl_psc_exp_ie::prune_ie_history_()
+{
+  // spikes up to the oldest last modulator spike are never read again
+  if ( ie_->t_lastspike_.empty() )
+  {
+    ie_->hist_.clear();
+    return;
+  }
+
+  const double oldest = *std::min_element(
+    ie_->t_lastspike_.begin(), ie_->t_lastspike_.end() );
+  const long oldest_step = nest::Time( nest::Time::ms( oldest ) ).get_steps();
+  ie_->hist_.erase( ie_->hist_.begin(),
+    std::upper_bound( ie_->hist_.begin(), ie_->hist_.end(), oldest_step ) );
+}
+
 
 void
 mynest::lifl_psc_exp_ie::handle( nest::CurrentEvent& e )
@@ -523,16 +701,16 @@ mynest::lifl_psc_exp_ie::handle( nest::CurrentEvent& e )
   // add weighted current; HEP 2002-10-04
   if ( 0 == e.get_rport() )
   {
-    B_.currents_[ 0 ].add_value(
-      e.get_rel_delivery_steps(
-        nest::kernel().simulation_manager.get_slice_origin() ),
+    B_.input_.add_value( e.get_rel_delivery_steps(
+                           nest::kernel().simulation_manager.get_slice_origin() ),
+      Buffers_::CURRENT_0,
       w * c );
   }
   if ( 1 == e.get_rport() )
   {
-    B_.currents_[ 1 ].add_value(
-      e.get_rel_delivery_steps(
-        nest::kernel().simulation_manager.get_slice_origin() ),
+    B_.input_.add_value( e.get_rel_delivery_steps(
+                           nest::kernel().simulation_manager.get_slice_origin() ),
+      Buffers_::CURRENT_1,
       w * c );
   }
 }
@@ -542,3 +720,181 @@ mynest::lifl_psc_exp_ie::handle( nest::DataLoggingRequest& e )
 {
   B_.logger_.handle( e );
 }
+
+void
+mynest::lifl_psc_exp_ie::connect_aggregator( lfp_aggregator& aggregator,
+  double weight_ex,
+  double weight_in )
+{
+  aggregators_.add( aggregator, weight_ex, weight_in );
+}
+
+void
+mynest::lifl_psc_exp_ie::connect_ie_recorder( ie_recorder& recorder )
+{
+  ie_recorders_.push_back( &recorder );
+}
+
+/* ----------------------------------------------------------------
+ * Checkpointing
+ * ---------------------------------------------------------------- */
+
+void
+mynest::lifl_psc_exp_ie::save_checkpoint( CheckpointWriter& w )
+{
+  w.begin_node( get_gid(), "lifl_psc_exp_ie" );
+
+  CheckpointBuffer dyn;
+  save_dynamics_( dyn );
+  w.section( CKPT_DYNAMICS, dyn, ckpt_ );
+
+  CheckpointBuffer plast;
+  save_plasticity_( plast );
+  w.section( CKPT_PLASTICITY, plast, ckpt_ );
+
+  if ( ckpt_.buffers_ready() )
+  {
+    CheckpointBuffer buf;
+    save_buffers_( buf );
+    w.section( CKPT_BUFFERS, buf, ckpt_ );
+  }
+
+  w.end_node();
+}
+
+void
+mynest::lifl_psc_exp_ie::restore_checkpoint( const CheckpointReader& r )
+{
+  if ( r.family() != "lifl_psc_exp_ie" )
+  {
+    throw CheckpointError( "Checkpoint record of node "
+      + std::to_string( get_gid() ) + " was written by " + r.family() + "." );
+  }
+
+  // read into temporaries, so that a corrupt record leaves S_ untouched
+  State_ stmp = S_;
+  IEHistory_ ietmp = *ie_;
+
+  if ( r.has_section( CKPT_DYNAMICS ) )
+  {
+    CheckpointBuffer dyn = r.get_section( CKPT_DYNAMICS );
+    dyn.get( stmp.i_0_ );
+    dyn.get( stmp.i_1_ );
+    dyn.get( stmp.i_syn_ex_ );
+    dyn.get( stmp.i_syn_in_ );
+    dyn.get( stmp.V_m_ );
+    dyn.get( stmp.Vpositive );
+    dyn.get( stmp.r_ref_ );
+  }
+
+  if ( r.has_section( CKPT_PLASTICITY ) )
+  {
+    CheckpointBuffer plast = r.get_section( CKPT_PLASTICITY );
+    plast.get( stmp.enhancement );
+    plast.get( ietmp.hist_ );
+    plast.get( ietmp.t_lastspike_ );
+
+    // time stamps are stored relative to the time of saving, see
+    // save_plasticity_()
+    const nest::Time now = nest::kernel().simulation_manager.get_time();
+    for ( size_t i = 0; i < ietmp.hist_.size(); ++i )
+    {
+      ietmp.hist_[ i ] += now.get_steps();
+    }
+    for ( size_t i = 0; i < ietmp.t_lastspike_.size(); ++i )
+    {
+      ietmp.t_lastspike_[ i ] += now.get_ms();
+    }
+  }
+
+  S_ = stmp;
+  *ie_ = ietmp;
+
+  if ( r.has_section( CKPT_BUFFERS ) )
+  {
+    CheckpointBuffer buf = r.get_section( CKPT_BUFFERS );
+    if ( ckpt_.buffers_ready() )
+    {
+      restore_buffers_( buf );
+    }
+    else
+    {
+      ckpt_.defer_buffers( buf ); // applied by init_buffers_()
+    }
+  }
+
+  // the next incremental checkpoint is relative to the restored state
+  CheckpointBuffer dyn;
+  save_dynamics_( dyn );
+  ckpt_.mark( CKPT_DYNAMICS, dyn );
+
+  CheckpointBuffer plast;
+  save_plasticity_( plast );
+  ckpt_.mark( CKPT_PLASTICITY, plast );
+}
+
+void
+mynest::lifl_psc_exp_ie::save_dynamics_( CheckpointBuffer& b ) const
+{
+  b.put( S_.i_0_ );
+  b.put( S_.i_1_ );
+  b.put( S_.i_syn_ex_ );
+  b.put( S_.i_syn_in_ );
+  b.put( S_.V_m_ );
+  b.put( S_.Vpositive );
+  b.put( S_.r_ref_ );
+}
+
+void
+mynest::lifl_psc_exp_ie::save_plasticity_( CheckpointBuffer& b ) const
+{
+  // Time stamps are written relative to the current time. They thus
+  // restore correctly into a network at any time, and the section counts
+  // as changed whenever time has advanced, so that an incremental
+  // checkpoint never leaves stamps of an earlier file in place.
+  const nest::Time now = nest::kernel().simulation_manager.get_time();
+
+  std::vector< long > hist( ie_->hist_.begin(), ie_->hist_.end() );
+  for ( size_t i = 0; i < hist.size(); ++i )
+  {
+    hist[ i ] -= now.get_steps();
+  }
+  std::vector< double > t_lastspike(
+    ie_->t_lastspike_.begin(), ie_->t_lastspike_.end() );
+  for ( size_t i = 0; i < t_lastspike.size(); ++i )
+  {
+    t_lastspike[ i ] -= now.get_ms();
+  }
+
+  b.put( S_.enhancement );
+  b.put( hist );
+  b.put( t_lastspike );
+}
+
+void
+mynest::lifl_psc_exp_ie::save_buffers_( CheckpointBuffer& b ) const
+{
+  // same layout as one CheckpointRingBuffer per channel: ex, in, I_0, I_1
+  B_.input_.save( b );
+}
+
+void
+mynest::lifl_psc_exp_ie::restore_buffers_( CheckpointBuffer& b )
+{
+  B_.input_.restore( b );
+}
+
+/* ----------------------------------------------------------------
+ * Instantiations for the model variants in lifl_psc_exp_variant.h
+ * ---------------------------------------------------------------- */
+
+template void mynest::lifl_psc_exp_ie::update_< false, false >(
+  const nest::Time&,
+  const long,
+  const long );
+template void mynest::lifl_psc_exp_ie::update_< true, false >(
+  const nest::Time&,
+  const long,
+  const long );
+template void mynest::lifl_psc_exp_ie::handle_spike_< false >(
+  nest::SpikeEvent& );
@@ -23,6 +23,10 @@
 #ifndef LIFL_PSC_EXP_IE_H
 #define LIFL_PSC_EXP_IE_H
 
+// C++ includes:
+#include <memory>
+#include <mutex>
+
 // Includes from nestkernel:
 #include "archiving_node.h"
 #include "connection.h"
@@ -30,12 +34,22 @@
 #include "nest_types.h"
 #include "recordables_map.h"
 #include "ring_buffer.h"
-#include "universal_data_logger.h"
+
+// Includes from librandom:
+#include "poisson_randomdev.h"
 
 
 // Includes from sli:
 #include "dictdatum.h"
 
+// Includes from LIFL_IE:
+#include "checkpoint.h"
+#include "gated_data_logger.h"
+#include "ie_arena.h"
+#include "ie_recorder.h"
+#include "lfp_aggregator.h"
+#include "multichannel_ring_buffer.h"
+
 
 namespace mynest
 {
@@ -109,6 +123,41 @@ namespace mynest
    tau      double . value of window of the intrinsic plasticity effect.
    std_mod  bool   . Swhich ON (true) or OFF (false) the intrinsic plasticity effect.
 
+   Trial reset
+
+   trial_period   double - Period of trial resets in ms, 0 disables them.
+   trial_reset_V  double - Membrane potential after a trial reset in mV.
+
+   At every multiple of trial_period after time 0, the membrane potential
+   is set to trial_reset_V and the synaptic currents and refractoriness
+   are cleared, while the IE plasticity state is kept. A whole training
+   schedule can so run in a single Simulate call instead of resetting V_m
+   from the interpreter before each trial.
+
+   Background input
+
+   bg_rate    double - Rate of background input spikes in spikes/s, 0
+                       disables it.
+   bg_weight  double - Weight of a background input spike in pA, negative
+                       for inhibitory input.
+
+   The background input is equivalent to a poisson_generator of rate
+   bg_rate connected with weight bg_weight, but the number of input spikes
+   in each step is drawn inside the neuron, so no spike events are
+   delivered.
+
+   Recording windows
+
+   record_windows  double array - start, stop pairs of the windows (ms) in
+                                  which multimeters sample the neuron;
+                                  empty to sample always.
+   record_period   double       - Period of the windows in ms, 0 if they
+                                  are in absolute time.
+
+   With record_period equal to trial_period, e.g. record_windows
+   [0., 100.] records only the first 100 ms of each trial. Outside the
+   windows, nothing is read, stored or sent to the multimeters.
+
 Remarks:
 
    If tau_m is very close to tau_syn_ex or tau_syn_in, the model
@@ -125,6 +174,23 @@ Remarks:
    kernel with the time constant of the excitatory synapse,
    tau_syn_ex. For an example application, see [4].
 
+   The complete dynamic state, including IE plasticity state and pending
+   input, can be saved and restored with SaveCheckpoint and
+   RestoreCheckpoint.
+
+   The enhancement soma_exc only changes when a modulator spike arrives;
+   an ie_recorder connected with ConnectIERecorder records these changes
+   without sampling soma_exc in every step.
+
+   The own spike times used by the IE plasticity are kept only while
+   std_mod is on and only back to the oldest last spike of the modulators,
+   since earlier spikes no longer contribute.
+
+   Nodes created from the same model share one copy of their parameters
+   and propagators, so large homogeneous populations are cheap to create
+   and calibrate. Setting a parameter of a single node gives it its own
+   copy.
+
    References:
    [1] Misha Tsodyks, Asher Uziel, and Henry Markram (2000) Synchrony Generation
    in Recurrent Networks with Frequency-Dependent Synapses, The Journal of
@@ -148,7 +214,8 @@ Remarks:
 
    Receives: SpikeEvent, CurrentEvent, DataLoggingRequest
 
-   SeeAlso: lifl_psc_exp_ie_ps
+   SeeAlso: lifl_psc_exp_ie_ps, SaveCheckpoint, RestoreCheckpoint,
+   ie_recorder
 
    FirstVersion: 2019-2020
    Author: Alejandro Santos-Mayo, based on iaf_psc_exp
@@ -157,7 +224,9 @@ Remarks:
 /**
  * Leaky integrate-and-fire neuron with exponential PSCs.
  */
-class lifl_psc_exp_ie : public nest::Archiving_Node
+class lifl_psc_exp_ie : public nest::Archiving_Node,
+                        public Checkpointable,
+                        public AggregatorSource
 {
 
 public:
@@ -185,16 +254,58 @@ public:
   void get_status( DictionaryDatum& ) const;
   void set_status( const DictionaryDatum& );
 
-private:
+  /**
+   * Replace the IE modulators, with the same effect as setting
+   * stimulator. Does not create SLI data, so it may be called in parallel
+   * from the threads owning the nodes.
+   */
+  void set_stimulators( const std::vector< long >& );
+
+  void save_checkpoint( CheckpointWriter& );
+  void restore_checkpoint( const CheckpointReader& );
+
+  void connect_aggregator( lfp_aggregator&, double, double );
+
+  //! Report the changes of the enhancement to recorder
+  void connect_ie_recorder( ie_recorder& );
+
+protected:
   void init_state_( const Node& proto );
   void init_buffers_();
   void calibrate();
 
+  void save_dynamics_( CheckpointBuffer& ) const;
+  void save_plasticity_( CheckpointBuffer& ) const;
+  void save_buffers_( CheckpointBuffer& ) const;
+  void restore_buffers_( CheckpointBuffer& );
+
   void update( const nest::Time&, const long, const long );
 
+  /**
+   * Update loop with the optional features fixed at compile time, see
+   * lifl_psc_exp_variant.
+   * @tparam ie                IE plasticity can be switched on (std_mod)
+   * @tparam filtered_current  current input through receptor_type 1
+   */
+  template < bool ie, bool filtered_current >
+  void update_( const nest::Time&, const long, const long );
+
+  //! Spike handling, with the IE modulation compiled in or out
+  template < bool ie >
+  void handle_spike_( nest::SpikeEvent& );
+
+  //! Reset membrane and synaptic state at a trial boundary
+  void reset_trial_();
+
+  //! Append an own spike at the given step to the IE history
+  void record_ie_spike_( long );
+
+  //! Drop IE history entries no modulator can reach anymore
+  void prune_ie_history_();
+
   // The next two classes need to be friends to access the State_ class/member
   friend class nest::RecordablesMap< lifl_psc_exp_ie >;
-  friend class nest::UniversalDataLogger< lifl_psc_exp_ie >;
+  friend class GatedDataLogger< lifl_psc_exp_ie >;
 
   // ----------------------------------------------------------------
 
@@ -234,12 +345,6 @@ private:
 
 	// Spike latency and Intrinsic Excitability parameters.
 
-    /** Auxiliar temporal variable to calculate the Spike Latency */
-    long stepms;
-
-    /** Time step resolution to take care of in operations */
-    double dt;
-
     /** Global ID of neuro-modulator neurons */
     std::vector< long > stimulator_;
 
@@ -252,6 +357,21 @@ private:
     /** std_mod can swich on / off the IE plasticity mechanism */
     bool std_mod;
 
+    /** Period of trial resets in ms, 0 for none */
+    double trial_period_;
+
+    /** Membrane potential after trial reset, RELATIVE TO RESTING POTENTIAL */
+    double trial_reset_V_;
+
+    /** Rate of background input spikes in spikes/s */
+    double bg_rate_;
+
+    /** Weight of a background input spike in pA */
+    double bg_weight_;
+
+    /** Windows in which the recordables are sampled */
+    RecordingGate record_gate_;
+
 
 
 
@@ -266,6 +386,46 @@ private:
      * @returns Change in reversal potential E_L, to be passed to State_::set()
      */
     double set( const DictionaryDatum& );
+
+    //! True if all parameters are equal
+    bool same_as( const Parameters_& ) const;
+  };
+
+  // ----------------------------------------------------------------
+
+  /**
+   * Parameters together with the propagators computed from them.
+   * All nodes created from the same prototype share one instance; a node
+   * gets its own copy only when set_status changes one of its parameters.
+   */
+  struct SharedParameters_ : public Parameters_
+  {
+    explicit SharedParameters_( const Parameters_& );
+
+    /** Compute propagators for resolution h unless already done.
+     * Nodes sharing the instance may be calibrated by different threads.
+     */
+    void calibrate( double h );
+
+    // time evolution operator
+    double P20_;
+    double P11ex_;
+    double P11in_;
+    double P21ex_;
+    double P21in_;
+    double P22_;
+
+    int RefractoryCounts_;
+
+    long TrialSteps_; //!< trial period in steps, 0 for no trial resets
+
+    /** Resolution in ms the propagators were computed for, 0 if they have
+     * not been computed yet.
+     */
+    double h_;
+
+  private:
+    std::mutex mutex_;
   };
 
   // ----------------------------------------------------------------
@@ -275,24 +435,19 @@ private:
    */
   struct State_
   {
-    // state variables
+    // state variables, in the order update() uses them; all of them are
+    // touched in every step, so they are kept next to each other
+    double V_m_;      //!< membrane potential, variable 2
+    double i_syn_ex_; //!< postsynaptic current for exc. inputs, variable 1
+    double i_syn_in_; //!< postsynaptic current for inh. inputs, variable 1
     //! synaptic stepwise constant input current, variable 0
     double i_0_;
     double i_1_;      //!< presynaptic stepwise constant input current
-    double i_syn_ex_; //!< postsynaptic current for exc. inputs, variable 1
-    double i_syn_in_; //!< postsynaptic current for inh. inputs, variable 1
-    double V_m_;      //!< membrane potential, variable 2
-   
+
        // Spike latency and Intrinsic Excitability States
 
-    double Vpositive; //!< Auxiliar value used to correctly calculate spike latency
     double enhancement; //!< Intrinsic Excitability value modulator of incoming current.
-        
-    std::vector< long > hist_;
-
-    std::vector< double > t_lastspike_;
-
-
+    double Vpositive; //!< Auxiliar value used to correctly calculate spike latency
 
     //! absolute refractory counter (no membrane potential propagation)
     int r_ref_;
@@ -311,6 +466,39 @@ private:
 
   // ----------------------------------------------------------------
 
+  /**
+   * Spike history used by the IE plasticity.
+   * Only touched when the neuron or one of its modulators spikes, so it
+   * is kept apart from the state that is updated in every step.
+   * The record and its containers live in the IEArena of the thread that
+   * created or grew them, so that the histories of a population share a
+   * few slabs instead of one heap allocation each.
+   */
+  struct IEHistory_
+  {
+    typedef std::vector< long, IEArenaAllocator< long > > History;
+
+    //! own spike times in steps, ascending, pruned by prune_ie_history_()
+    History hist_;
+
+    //! last spike time per modulator
+    std::vector< double, IEArenaAllocator< double > > t_lastspike_;
+
+    static void*
+    operator new( size_t size )
+    {
+      return IEArena::local().allocate( size );
+    }
+
+    static void
+    operator delete( void* p )
+    {
+      IEArena::release( p );
+    }
+  };
+
+  // ----------------------------------------------------------------
+
   /**
    * Buffers of the model.
    */
@@ -319,13 +507,26 @@ private:
     Buffers_( lifl_psc_exp_ie& );
     Buffers_( const Buffers_&, lifl_psc_exp_ie& );
 
-    /** buffers and sums up incoming spikes/currents */
-    nest::RingBuffer spikes_ex_;
-    nest::RingBuffer spikes_in_;
-    std::vector< nest::RingBuffer > currents_;
+    //! Input channels of the ring buffer
+    enum InputChannels
+    {
+      SPIKES_EX = 0,
+      SPIKES_IN,
+      CURRENT_0,
+      CURRENT_1,
+      NUM_INPUT_CHANNELS
+    };
+
+    /** buffers and sums up incoming spikes/currents, all channels of one
+        lag are stored together and read at once in update() */
+    typedef MultiChannelRingBuffer< NUM_INPUT_CHANNELS > Input;
+    Input input_;
 
     //! Logger for all analog data
-    nest::UniversalDataLogger< lifl_psc_exp_ie > logger_;
+    GatedDataLogger< lifl_psc_exp_ie > logger_;
+
+    //! Number of background input spikes per step
+    librandom::PoissonRandomDev bg_dev_;
   };
 
   // ----------------------------------------------------------------
@@ -342,18 +543,8 @@ private:
     */
     //    double PSCInitialValue_;
 
-    // time evolution operator
-    double P20_;
-    double P11ex_;
-    double P11in_;
-    double P21ex_;
-    double P21in_;
-    double P22_;
-
     double weighted_spikes_ex_;
     double weighted_spikes_in_;
-
-    int RefractoryCounts_;
   };
 
   // Access functions for UniversalDataLogger -------------------------------
@@ -362,7 +553,7 @@ private:
   inline double
   get_V_m_() const
   {
-    return S_.V_m_ + P_.E_L_;
+    return S_.V_m_ + P_->E_L_;
   }
 
   // INTRINSIC EXCTIABILITY value
@@ -402,15 +593,27 @@ private:
    * @defgroup lifl_psc_exp_ie_data
    * Instances of private data structures for the different types
    * of data pertaining to the model.
-   * @note The order of definitions is important for speed.
+   * @note The order of definitions is important for speed: the state and
+   *       variables written in every step come first and are contiguous,
+   *       data only touched on spikes or by devices follows.
    * @{
    */
-  Parameters_ P_;
   State_ S_;
   Variables_ V_;
+  std::shared_ptr< SharedParameters_ > P_; //!< shared, copied on write
   Buffers_ B_;
+  std::unique_ptr< IEHistory_ > ie_;
   /** @} */
 
+  //! Checkpoint bookkeeping
+  CheckpointState ckpt_;
+
+  //! LFP aggregators the synaptic currents are added to
+  AggregatorTargets aggregators_;
+
+  //! Recorders of the changes of the enhancement
+  std::vector< ie_recorder* > ie_recorders_;
+
   //! Mapping of recordables names to access functions
   static nest::RecordablesMap< lifl_psc_exp_ie > recordablesMap_;
 };
@@ -467,8 +670,8 @@ mynest::lifl_psc_exp_ie::handles_test_event( nest::DataLoggingRequest& dlr, nest
 inline void
 lifl_psc_exp_ie::get_status( DictionaryDatum& d ) const
 {
-  P_.get( d );
-  S_.get( d, P_ );
+  P_->get( d );
+  S_.get( d, *P_ );
   Archiving_Node::get_status( d );
 
   ( *d )[ nest::names::recordables ] = recordablesMap_.get_list();
@@ -477,7 +680,7 @@ lifl_psc_exp_ie::get_status( DictionaryDatum& d ) const
 inline void
 lifl_psc_exp_ie::set_status( const DictionaryDatum& d )
 {
-  Parameters_ ptmp = P_;                 // temporary copy in case of errors
+  Parameters_ ptmp = *P_;                // temporary copy in case of errors
   const double delta_EL = ptmp.set( d ); // throws if BadProperty
   State_ stmp = S_;                      // temporary copy in case of errors
   stmp.set( d, ptmp, delta_EL );         // throws if BadProperty
@@ -488,8 +691,12 @@ lifl_psc_exp_ie::set_status( const DictionaryDatum& d )
   // consistent.
   Archiving_Node::set_status( d );
 
-  // if we get here, temporaries contain consistent set of properties
-  P_ = ptmp;
+  // if we get here, temporaries contain consistent set of properties;
+  // other nodes keep the shared parameters if only the state was changed
+  if ( not ptmp.same_as( *P_ ) )
+  {
+    P_ = std::make_shared< SharedParameters_ >( ptmp );
+  }
   S_ = stmp;
 }
 
@@ -0,0 +1,156 @@
+/*
+ *  lifl_psc_exp_variant.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIFL_PSC_EXP_VARIANT_H
+#define LIFL_PSC_EXP_VARIANT_H
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "dictutils.h"
+
+// Includes from LIFL_IE:
+#include "lifl_psc_exp_ie.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: lifl_psc_exp - lifl_psc_exp_ie with optional features compiled out.
+
+   Description:
+   lifl_psc_exp and lifl_psc_exp_ie_nofilter are variants of lifl_psc_exp_ie
+   in which the features a population does not use are removed at compile
+   time, so that their update and spike handling carry no branches for them:
+
+   lifl_psc_exp              - no IE plasticity, no filtered current input
+   lifl_psc_exp_ie_nofilter  - IE plasticity, no filtered current input
+   lifl_psc_exp_ie           - all features
+
+   Without IE plasticity, std_mod is false and cannot be switched on, and
+   modulator spikes are treated as ordinary input. Without filtered current
+   input, connections to receptor_type 1 are rejected.
+
+   All variants have the same parameters, state and recordables as
+   lifl_psc_exp_ie and write checkpoints of the same family, so a
+   population can be moved between variants by SaveCheckpoint and
+   RestoreCheckpoint, or by passing the status of one node to another.
+
+   Use lifl_psc_exp for the large detector populations that are created
+   with std_mod false, e.g. the SS4 neurons of the V1 column example.
+
+   Receives: SpikeEvent, CurrentEvent, DataLoggingRequest
+
+   Sends: SpikeEvent
+
+   SeeAlso: lifl_psc_exp_ie
+
+   FirstVersion: 2020
+*/
+
+/**
+ * lifl_psc_exp_ie with IE plasticity and filtered current input fixed at
+ * compile time.
+ */
+template < bool ie, bool filtered_current >
+class lifl_psc_exp_variant : public lifl_psc_exp_ie
+{
+
+public:
+  lifl_psc_exp_variant();
+
+  using lifl_psc_exp_ie::handle;
+  using lifl_psc_exp_ie::handles_test_event;
+
+  void handle( nest::SpikeEvent& );
+
+  nest::port handles_test_event( nest::CurrentEvent&, nest::rport );
+
+  void set_status( const DictionaryDatum& );
+
+private:
+  void update( const nest::Time&, const long, const long );
+};
+
+typedef lifl_psc_exp_variant< false, false > lifl_psc_exp;
+typedef lifl_psc_exp_variant< true, false > lifl_psc_exp_ie_nofilter;
+
+template < bool ie, bool filtered_current >
+lifl_psc_exp_variant< ie, filtered_current >::lifl_psc_exp_variant()
+  : lifl_psc_exp_ie()
+{
+  if ( not ie )
+  {
+    Parameters_ p = *P_;
+    p.std_mod = false;
+    P_ = std::make_shared< SharedParameters_ >( p );
+  }
+}
+
+template < bool ie, bool filtered_current >
+inline void
+lifl_psc_exp_variant< ie, filtered_current >::handle( nest::SpikeEvent& e )
+{
+  handle_spike_< ie >( e );
+}
+
+template < bool ie, bool filtered_current >
+inline nest::port
+lifl_psc_exp_variant< ie, filtered_current >::handles_test_event(
+  nest::CurrentEvent& e,
+  nest::rport receptor_type )
+{
+  if ( not filtered_current and receptor_type == 1 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  return lifl_psc_exp_ie::handles_test_event( e, receptor_type );
+}
+
+template < bool ie, bool filtered_current >
+void
+lifl_psc_exp_variant< ie, filtered_current >::set_status(
+  const DictionaryDatum& d )
+{
+  bool std_mod = false;
+  if ( not ie and updateValue< bool >( d, nest::names::std_mod, std_mod )
+    and std_mod )
+  {
+    throw nest::BadProperty( "This model variant has no IE plasticity, "
+                             "use lifl_psc_exp_ie." );
+  }
+  lifl_psc_exp_ie::set_status( d );
+}
+
+template < bool ie, bool filtered_current >
+void
+lifl_psc_exp_variant< ie, filtered_current >::update( const nest::Time& origin,
+  const long from,
+  const long to )
+{
+  update_< ie, filtered_current >( origin, from, to );
+}
+
+} // namespace mynest
+
+#endif // LIFL_PSC_EXP_VARIANT_H
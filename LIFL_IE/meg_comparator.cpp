@@ -0,0 +1,365 @@
+/*
+ *  meg_comparator.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "meg_comparator.h"
+
+// C++ includes:
+#include <cmath>
+
+// Includes from libnestutil:
+#include "numerics.h"
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Running moments
+ * ---------------------------------------------------------------- */
+
+mynest::meg_comparator::Moments_::Moments_()
+  : n_( 0 )
+  , mean_x_( 0.0 )
+  , mean_y_( 0.0 )
+  , m2_x_( 0.0 )
+  , m2_y_( 0.0 )
+  , c_xy_( 0.0 )
+  , sse_( 0.0 )
+{
+}
+
+void
+mynest::meg_comparator::Moments_::add( const double x, const double y )
+{
+  ++n_;
+  const double dx = x - mean_x_;
+  const double dy = y - mean_y_;
+  mean_x_ += dx / n_;
+  mean_y_ += dy / n_;
+  m2_x_ += dx * ( x - mean_x_ );
+  m2_y_ += dy * ( y - mean_y_ );
+  c_xy_ += dx * ( y - mean_y_ );
+  sse_ += ( x - y ) * ( x - y );
+}
+
+double
+mynest::meg_comparator::Moments_::correlation() const
+{
+  if ( n_ < 2 or m2_x_ <= 0 or m2_y_ <= 0 )
+  {
+    return numerics::nan;
+  }
+  return c_xy_ / std::sqrt( m2_x_ * m2_y_ );
+}
+
+double
+mynest::meg_comparator::Moments_::rmse() const
+{
+  return n_ > 0 ? std::sqrt( sse_ / n_ ) : numerics::nan;
+}
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters and state
+ * ---------------------------------------------------------------- */
+
+mynest::meg_comparator::Parameters_::Parameters_()
+  : source_( 0 )
+  , reference_()
+  , reference_interval_( 1.0 ) // ms
+  , max_lag_( 0.0 )            // ms
+  , scale_( 1.0 )
+{
+}
+
+mynest::meg_comparator::State_::State_()
+  : bin_( -1 )
+  , bin_sum_( 0.0 )
+  , bin_count_( 0 )
+  , lags_( 1 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter and state extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+long
+mynest::meg_comparator::Parameters_::max_lag_bins() const
+{
+  return static_cast< long >(
+    std::floor( max_lag_ / reference_interval_ + 0.5 ) );
+}
+
+void
+mynest::meg_comparator::Parameters_::get( DictionaryDatum& d ) const
+{
+  def< long >( d, names::source, source_ );
+  ( *d )[ names::reference ] =
+    DoubleVectorDatum( new std::vector< double >( reference_ ) );
+  def< double >( d, names::reference_interval, reference_interval_ );
+  def< double >( d, names::max_lag, max_lag_ );
+  def< double >( d, names::scale, scale_ );
+}
+
+bool
+mynest::meg_comparator::Parameters_::set( const DictionaryDatum& d )
+{
+  bool restart = false;
+  restart |= updateValue< long >( d, names::source, source_ );
+  restart |=
+    updateValue< std::vector< double > >( d, names::reference, reference_ );
+  restart |=
+    updateValue< double >( d, names::reference_interval, reference_interval_ );
+  restart |= updateValue< double >( d, names::max_lag, max_lag_ );
+  updateValue< double >( d, names::scale, scale_ );
+
+  if ( source_ < 0 )
+  {
+    throw nest::BadProperty( "source must be the GID of an lfp_aggregator." );
+  }
+  if ( reference_interval_ <= 0 )
+  {
+    throw nest::BadProperty( "reference_interval must be positive." );
+  }
+  if ( max_lag_ < 0 )
+  {
+    throw nest::BadProperty( "max_lag must not be negative." );
+  }
+  return restart;
+}
+
+void
+mynest::meg_comparator::State_::get( DictionaryDatum& d,
+  const Parameters_& p ) const
+{
+  const long max_lag = ( lags_.size() - 1 ) / 2;
+  const Moments_& lag_zero = lags_[ max_lag ];
+  def< long >( d, names::n_samples, lag_zero.n_ );
+  def< double >( d, names::correlation, lag_zero.correlation() );
+  def< double >( d, names::rmse, lag_zero.rmse() );
+
+  std::vector< double >* lags = new std::vector< double >( lags_.size() );
+  std::vector< double >* xcorr = new std::vector< double >( lags_.size() );
+  double best_lag = numerics::nan;
+  double best_correlation = numerics::nan;
+  for ( size_t k = 0; k < lags_.size(); ++k )
+  {
+    ( *lags )[ k ] = ( static_cast< long >( k ) - max_lag )
+      * p.reference_interval_;
+    ( *xcorr )[ k ] = lags_[ k ].correlation();
+
+    // lags without a defined correlation are skipped
+    if ( not std::isnan( ( *xcorr )[ k ] )
+      and ( std::isnan( best_correlation )
+            or ( *xcorr )[ k ] > best_correlation ) )
+    {
+      best_lag = ( *lags )[ k ];
+      best_correlation = ( *xcorr )[ k ];
+    }
+  }
+  ( *d )[ names::lags ] = DoubleVectorDatum( lags );
+  ( *d )[ names::xcorr ] = DoubleVectorDatum( xcorr );
+  def< double >( d, names::best_lag, best_lag );
+  def< double >( d, names::best_correlation, best_correlation );
+}
+
+bool
+mynest::meg_comparator::State_::set( const DictionaryDatum& d )
+{
+  long n_samples;
+  if ( updateValue< long >( d, names::n_samples, n_samples ) )
+  {
+    if ( n_samples != 0 )
+    {
+      throw nest::BadProperty( "n_samples can only be set to 0." );
+    }
+    return true;
+  }
+  return false;
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::meg_comparator::meg_comparator()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , S_()
+  , source_node_( 0 )
+{
+}
+
+mynest::meg_comparator::meg_comparator( const meg_comparator& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , S_( n.S_ )
+  , source_node_( 0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::meg_comparator::init_state_( const Node& proto )
+{
+  const meg_comparator& pr = downcast< meg_comparator >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::meg_comparator::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::meg_comparator::calibrate()
+{
+  device_.calibrate();
+
+  V_.t0_ = device_.get_origin().get_ms() + device_.get_start().get_ms();
+  V_.max_lag_bins_ = P_.max_lag_bins();
+
+  if ( get_thread() != 0 )
+  {
+    return;
+  }
+
+  lfp_aggregator* source = 0;
+  if ( P_.source_ > 0 )
+  {
+    source = dynamic_cast< lfp_aggregator* >(
+      nest::kernel().node_manager.get_node( P_.source_, 0 ) );
+    if ( source == 0 )
+    {
+      throw nest::BadProperty(
+        "source must be the GID of an lfp_aggregator." );
+    }
+  }
+
+  if ( source != source_node_ )
+  {
+    if ( source_node_ != 0 )
+    {
+      source_node_->remove_sink( *this );
+    }
+    if ( source != 0 )
+    {
+      source->add_sink( *this );
+    }
+    source_node_ = source;
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and comparison functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::meg_comparator::update( nest::Time const&, const long, const long )
+{
+  // the samples are pushed by the aggregator, see receive_sample
+}
+
+void
+mynest::meg_comparator::receive_sample( const double t, const double value )
+{
+  const long n_reference = P_.reference_.size();
+  const double rel = ( t - V_.t0_ ) / P_.reference_interval_;
+  if ( n_reference == 0 or rel < 0
+    or not device_.is_active( nest::Time::ms( t ) ) )
+  {
+    return;
+  }
+
+  // bins past the reference still pair with it at negative lags
+  const long bin = static_cast< long >( std::floor( rel ) );
+  if ( bin >= n_reference + V_.max_lag_bins_ )
+  {
+    finish_bin_(); // the last bin that pairs with the reference
+    return;
+  }
+
+  if ( bin != S_.bin_ )
+  {
+    finish_bin_();
+    S_.bin_ = bin;
+  }
+  S_.bin_sum_ += value;
+  ++S_.bin_count_;
+}
+
+void
+mynest::meg_comparator::post_run_cleanup()
+{
+  if ( get_thread() != 0 or source_node_ == 0 or S_.bin_count_ == 0 )
+  {
+    return;
+  }
+
+  // no further samples of the current bin will arrive, so that the last
+  // bin of the run is compared without waiting for a later one
+  const double end = V_.t0_ + ( S_.bin_ + 1 ) * P_.reference_interval_;
+  if ( end <= source_node_->sampled_until()
+        + 0.5 * nest::Time::get_resolution().get_ms() )
+  {
+    finish_bin_();
+  }
+}
+
+void
+mynest::meg_comparator::finish_bin_()
+{
+  if ( S_.bin_count_ == 0 )
+  {
+    return;
+  }
+
+  const long n_reference = P_.reference_.size();
+  const double x = P_.scale_ * S_.bin_sum_ / S_.bin_count_;
+  for ( long lag = -V_.max_lag_bins_; lag <= V_.max_lag_bins_; ++lag )
+  {
+    const long k = S_.bin_ + lag;
+    if ( 0 <= k and k < n_reference )
+    {
+      S_.lags_[ lag + V_.max_lag_bins_ ].add( x, P_.reference_[ k ] );
+    }
+  }
+
+  S_.bin_sum_ = 0.0;
+  S_.bin_count_ = 0;
+}
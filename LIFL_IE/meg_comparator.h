@@ -0,0 +1,267 @@
+/*
+ *  meg_comparator.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MEG_COMPARATOR_H
+#define MEG_COMPARATOR_H
+
+// C++ includes:
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+// Includes from LIFL_IE:
+#include "lfp_aggregator.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: meg_comparator - Compares an LFP signal with a reference online.
+
+   Description:
+   The meg_comparator compares the signal of an lfp_aggregator with a
+   reference time series, such as the MEG recording of the V1 example,
+   while the signal is simulated. Only the fit metrics are kept, so that
+   parameter searches against the reference need no analog recording;
+   the aggregator may run with to_memory false.
+
+   The reference samples are reference_interval apart; sample k covers
+   the time bin [t0 + k * reference_interval, t0 + (k + 1) *
+   reference_interval), t0 = origin + start of the comparator. The
+   samples of the aggregator falling into a bin are averaged, multiplied
+   by scale and compared with the reference sample when the first
+   sample of a later bin arrives, or at the end of a simulation once the
+   aggregator has passed on all samples of the bin. The latter requires
+   the comparator to be created after its aggregator; otherwise the last
+   bin of a simulation is compared in the next one. Samples after stop
+   are ignored.
+
+   Running Pearson correlation and RMSE are kept for lag 0. For the
+   cross-correlation, the correlation is kept for every lag of up to
+   max_lag in either direction, in steps of reference_interval; at lag
+   l, simulated bin k is compared with reference sample k + l, so a
+   positive best_lag means that the reference lags behind the
+   simulation. All metrics are updated one bin at a time with
+   numerically stable running moments.
+
+   Setting n_samples to 0, or changing source, reference,
+   reference_interval or max_lag, restarts the comparison.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   source              int          - GID of the lfp_aggregator
+   reference           double array - Reference time series
+   reference_interval  double       - Sampling interval of the reference
+                                      in ms
+   max_lag             double       - Largest lag of the cross-correlation
+                                      in ms
+   scale               double       - Factor applied to the signal
+
+   The following values are read only:
+
+   n_samples         int          - Bins compared at lag 0
+   correlation       double       - Pearson correlation at lag 0
+   rmse              double       - Root mean squared error at lag 0
+   lags              double array - Lags of the cross-correlation in ms
+   xcorr             double array - Correlation at each lag
+   best_lag          double       - Lag of the largest correlation in ms
+   best_correlation  double       - Largest correlation
+
+   Example:
+   Compare the pinwheel signal with 500 ms of MEG sampled at 600 Hz:
+
+   cmp = nest.Create('meg_comparator', 1, {
+             'source': pinwheel[0], 'reference': list(meg),
+             'reference_interval': 1000.0 / 600, 'max_lag': 50.0})
+   nest.Simulate(600.0)
+   print(nest.GetStatus(cmp, ['correlation', 'best_lag'])[0])
+
+   SeeAlso: lfp_aggregator
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device comparing the signal of an lfp_aggregator with a reference.
+ */
+class meg_comparator : public nest::DeviceNode, public SignalSink
+{
+
+public:
+  meg_comparator();
+  meg_comparator( const meg_comparator& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  void receive_sample( double, double );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+  void post_run_cleanup();
+
+  void update( nest::Time const&, const long, const long );
+
+  //! Compare the mean of the current bin with the reference
+  void finish_bin_();
+
+  // ------------------------------------------------------------
+
+  /**
+   * Running means and co-moments of two series (Welford).
+   */
+  struct Moments_
+  {
+    long n_;
+    double mean_x_;
+    double mean_y_;
+    double m2_x_; //!< sum of squared deviations of x
+    double m2_y_; //!< sum of squared deviations of y
+    double c_xy_; //!< sum of products of deviations
+    double sse_;  //!< sum of squared differences
+
+    Moments_();
+
+    void add( double, double );
+    double correlation() const;
+    double rmse() const;
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    long source_;                     //!< GID of the aggregator
+    std::vector< double > reference_; //!< Reference series
+    double reference_interval_;       //!< Reference sampling interval in ms
+    double max_lag_;                  //!< Largest lag in ms
+    double scale_;                    //!< Factor applied to the signal
+
+    Parameters_(); //!< Sets default parameter values
+
+    //! Number of lags in either direction
+    long max_lag_bins() const;
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+
+    //! Set values from dictionary, return true if the comparison restarts
+    bool set( const DictionaryDatum& );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * State variables of the model, only used on thread 0.
+   */
+  struct State_
+  {
+    long bin_;                     //!< Bin being accumulated, -1 if none
+    double bin_sum_;               //!< Sum of the signal in the bin
+    long bin_count_;               //!< Samples in the bin
+    std::vector< Moments_ > lags_; //!< Moments per lag, from -max_lag
+
+    State_(); //!< Default initialization
+
+    void get( DictionaryDatum&, const Parameters_& ) const;
+
+    //! Return true if the comparison restarts
+    bool set( const DictionaryDatum& );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    double t0_;         //!< Start of the first bin in ms
+    long max_lag_bins_; //!< Number of lags in either direction
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  Parameters_ P_;
+  State_ S_;
+  Variables_ V_;
+
+  //! Aggregator this comparator is registered with, on thread 0
+  lfp_aggregator* source_node_;
+};
+
+inline void
+meg_comparator::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+
+  // the comparison is done by the instance on thread 0 only
+  if ( get_thread() == 0 )
+  {
+    S_.get( d, P_ );
+  }
+}
+
+inline void
+meg_comparator::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_;                 // temporary copy in case of errors
+  const bool new_params = ptmp.set( d ); // throws if BadProperty
+  State_ stmp = S_;
+  const bool restart = stmp.set( d ) or new_params;
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+  S_ = stmp;
+  if ( restart )
+  {
+    S_ = State_();
+    S_.lags_.resize( 2 * P_.max_lag_bins() + 1 );
+  }
+}
+
+} // namespace mynest
+
+#endif // MEG_COMPARATOR_H
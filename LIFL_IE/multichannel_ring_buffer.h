@@ -0,0 +1,228 @@
+/*
+ *  multichannel_ring_buffer.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTICHANNEL_RING_BUFFER_H
+#define MULTICHANNEL_RING_BUFFER_H
+
+// C++ includes:
+#include <algorithm>
+#include <cassert>
+#include <array>
+#include <vector>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_types.h"
+
+// Includes from LIFL_IE:
+#include "checkpoint.h"
+
+namespace mynest
+{
+
+/**
+ * Ring buffer for several input channels (excitatory and inhibitory
+ * spikes, currents, ...) that are read at the same lag.
+ *
+ * The values of all channels of one lag are stored next to each other, so
+ * that reading the input of a step touches a single small block of memory
+ * and can be done with one vector-width load, instead of one access to a
+ * separately allocated nest::RingBuffer per channel.
+ *
+ * Like CheckpointRingBuffer, the pending content can be written to and
+ * restored from a checkpoint. Each channel is serialized in the same
+ * format as a CheckpointRingBuffer, one after the other.
+ */
+template < size_t num_channels >
+class MultiChannelRingBuffer
+{
+public:
+  //! Values of all channels at one lag
+  typedef std::array< double, num_channels > Channels;
+
+  MultiChannelRingBuffer();
+
+  /**
+   * Add a value to one channel of the ring buffer.
+   * @param  offs     Arrival time relative to beginning of slice.
+   * @param  channel  Input channel.
+   * @param  double   Value to add.
+   */
+  void add_value( const long offs, const size_t channel, const double );
+
+  /**
+   * Read the values of all channels and reset them to zero.
+   * @param  offs  Offset of element to read within slice.
+   * @returns values of all channels
+   */
+  Channels get_values( const long offs );
+
+  /**
+   * Initialize the buffer with noughts.
+   * Also resizes the buffer if necessary.
+   */
+  void clear();
+
+  /**
+   * Resize the buffer according to max_thread and max_delay.
+   */
+  void resize();
+
+  size_t
+  size() const
+  {
+    return buffer_.size();
+  }
+
+  //! Append the pending content of all channels to a checkpoint section
+  void save( CheckpointBuffer& ) const;
+
+  //! Replace the content by the one stored in a checkpoint section
+  void restore( CheckpointBuffer& );
+
+private:
+  //! Buffered data, one block of channels per lag
+  std::vector< Channels > buffer_;
+
+  /**
+   * Obtain buffer index.
+   * @param delay delivery delay for event
+   * @returns index to buffer element into which event should be
+   * recorded.
+   */
+  size_t get_index_( const nest::delay d ) const;
+
+  static size_t required_size_();
+};
+
+template < size_t num_channels >
+MultiChannelRingBuffer< num_channels >::MultiChannelRingBuffer()
+  : buffer_( required_size_() )
+{
+  clear();
+}
+
+template < size_t num_channels >
+inline void
+MultiChannelRingBuffer< num_channels >::add_value( const long offs,
+  const size_t channel,
+  const double v )
+{
+  assert( channel < num_channels );
+  buffer_[ get_index_( offs ) ][ channel ] += v;
+}
+
+template < size_t num_channels >
+inline typename MultiChannelRingBuffer< num_channels >::Channels
+MultiChannelRingBuffer< num_channels >::get_values( const long offs )
+{
+  assert( 0 <= offs and ( size_t ) offs < buffer_.size() );
+  assert( ( nest::delay ) offs
+    < nest::kernel().connection_manager.get_min_delay() );
+
+  // offs == 0 is beginning of slice, but we have to
+  // take modulo into account when indexing
+  Channels& entry = buffer_[ get_index_( offs ) ];
+  const Channels values = entry;
+  entry.fill( 0.0 ); // clear buffer after reading
+  return values;
+}
+
+template < size_t num_channels >
+void
+MultiChannelRingBuffer< num_channels >::resize()
+{
+  const size_t size = required_size_();
+  if ( buffer_.size() != size )
+  {
+    buffer_.resize( size );
+  }
+}
+
+template < size_t num_channels >
+void
+MultiChannelRingBuffer< num_channels >::clear()
+{
+  resize(); // does nothing if size is fine
+  Channels zero;
+  zero.fill( 0.0 );
+  std::fill( buffer_.begin(), buffer_.end(), zero ); // clear all elements
+}
+
+template < size_t num_channels >
+void
+MultiChannelRingBuffer< num_channels >::save( CheckpointBuffer& b ) const
+{
+  std::vector< double > pending( buffer_.size() );
+  for ( size_t c = 0; c < num_channels; ++c )
+  {
+    for ( size_t d = 0; d < buffer_.size(); ++d )
+    {
+      pending[ d ] = buffer_[ get_index_( d ) ][ c ];
+    }
+    b.put( pending );
+  }
+}
+
+template < size_t num_channels >
+void
+MultiChannelRingBuffer< num_channels >::restore( CheckpointBuffer& b )
+{
+  resize();
+  std::vector< Channels > restored( buffer_.size() );
+  std::vector< double > pending;
+  for ( size_t c = 0; c < num_channels; ++c )
+  {
+    b.get( pending );
+    if ( pending.size() != buffer_.size() )
+    {
+      throw CheckpointError(
+        "Checkpoint was written with different min/max delays." );
+    }
+    for ( size_t d = 0; d < buffer_.size(); ++d )
+    {
+      restored[ get_index_( d ) ][ c ] = pending[ d ];
+    }
+  }
+  buffer_.swap( restored );
+}
+
+template < size_t num_channels >
+inline size_t
+MultiChannelRingBuffer< num_channels >::get_index_( const nest::delay d ) const
+{
+  const long idx = nest::kernel().event_delivery_manager.get_modulo( d );
+  assert( ( size_t ) idx < buffer_.size() );
+  return idx;
+}
+
+template < size_t num_channels >
+size_t
+MultiChannelRingBuffer< num_channels >::required_size_()
+{
+  return nest::kernel().connection_manager.get_min_delay()
+    + nest::kernel().connection_manager.get_max_delay();
+}
+
+} // namespace mynest
+
+#endif // MULTICHANNEL_RING_BUFFER_H
@@ -0,0 +1,323 @@
+/*
+ *  parallel_conditions.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "parallel_conditions.h"
+
+// C includes:
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C++ includes:
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+// Includes from nestkernel:
+#include "kernel_manager.h"
+#include "nest_names.h"
+#include "nest_time.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dictutils.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+namespace
+{
+/**
+ * State of a worker process, set in the worker right after the fork.
+ */
+struct WorkerContext
+{
+  bool is_worker;
+  nest::index detector;
+  double t_fork;
+  std::string result_file;
+};
+
+WorkerContext worker_context = { false, 0, 0.0, std::string() };
+}
+
+std::string
+mynest::ConditionWorkerError::message() const
+{
+  return msg_;
+}
+
+mynest::ConditionWorkers::ConditionWorkers( nest::index detector,
+  long n_conditions,
+  long max_workers )
+  : detector_( detector )
+  , n_conditions_( n_conditions )
+  , max_workers_( max_workers == 0 ? n_conditions : max_workers )
+  , t_fork_( nest::kernel().simulation_manager.get_time().get_ms() )
+  , senders_( n_conditions > 0 ? n_conditions : 0 )
+  , times_( n_conditions > 0 ? n_conditions : 0 )
+{
+  if ( n_conditions_ < 1 )
+  {
+    throw nest::BadProperty( "Number of conditions must be positive." );
+  }
+  if ( max_workers_ < 1 )
+  {
+    throw nest::BadProperty( "Number of workers must not be negative." );
+  }
+  if ( detector_ == 0 or detector_ >= nest::kernel().node_manager.size() )
+  {
+    throw nest::UnknownNode( detector_ );
+  }
+  if ( worker_context.is_worker )
+  {
+    throw ConditionWorkerError( "Conditions cannot be forked from a worker." );
+  }
+  if ( nest::kernel().vp_manager.get_num_threads() > 1
+    or nest::kernel().mpi_manager.get_num_processes() > 1 )
+  {
+    throw ConditionWorkerError(
+      "Forking conditions requires a single thread and MPI process." );
+  }
+
+  const char* tmpdir = std::getenv( "TMPDIR" );
+  std::ostringstream prefix;
+  prefix << ( tmpdir != 0 ? tmpdir : "/tmp" ) << "/lifl_ie_condition_"
+         << getpid() << "_";
+  prefix_ = prefix.str();
+}
+
+long
+mynest::ConditionWorkers::run()
+{
+  // do not let the workers flush the parent's buffered output again
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush( 0 );
+
+  std::map< pid_t, long > running;
+  std::vector< long > failed;
+  long next = 0;
+  while ( next < n_conditions_ or not running.empty() )
+  {
+    while ( next < n_conditions_
+      and static_cast< long >( running.size() ) < max_workers_ )
+    {
+      const pid_t pid = fork();
+      if ( pid == 0 )
+      {
+        worker_context.is_worker = true;
+        worker_context.detector = detector_;
+        worker_context.t_fork = t_fork_;
+        worker_context.result_file = result_file_( next );
+        return next;
+      }
+      if ( pid < 0 )
+      {
+        reap_workers_( running );
+        throw ConditionWorkerError( "Cannot fork worker process." );
+      }
+      running[ pid ] = next;
+      ++next;
+    }
+
+    // only reap our own workers, other children of the process (e.g. of
+    // Python's subprocess) are left to their owners; the workers run for
+    // much longer than the polling interval
+    int status = 0;
+    std::map< pid_t, long >::iterator w = running.begin();
+    for ( ; w != running.end(); ++w )
+    {
+      const pid_t pid = waitpid( w->first, &status, WNOHANG );
+      if ( pid < 0 )
+      {
+        reap_workers_( running );
+        throw ConditionWorkerError( "Lost track of worker processes." );
+      }
+      if ( pid == w->first )
+      {
+        break;
+      }
+    }
+    if ( w == running.end() )
+    {
+      usleep( 10000 );
+      continue;
+    }
+    const long condition = w->second;
+    running.erase( w );
+
+    if ( not( WIFEXITED( status ) and WEXITSTATUS( status ) == 0
+           and read_result_( condition ) ) )
+    {
+      failed.push_back( condition );
+    }
+    std::remove( result_file_( condition ).c_str() );
+  }
+
+  if ( not failed.empty() )
+  {
+    std::ostringstream msg;
+    msg << "Worker of condition " << failed[ 0 ] << " failed";
+    if ( failed.size() > 1 )
+    {
+      msg << " (and " << failed.size() - 1 << " more)";
+    }
+    msg << ".";
+    throw ConditionWorkerError( msg.str() );
+  }
+
+  return -1;
+}
+
+void
+mynest::ConditionWorkers::reap_workers_(
+  const std::map< pid_t, long >& running ) const
+{
+  // a worker that can not be waited for any more is gone already
+  for ( std::map< pid_t, long >::const_iterator w = running.begin();
+        w != running.end();
+        ++w )
+  {
+    waitpid( w->first, 0, 0 );
+    std::remove( result_file_( w->second ).c_str() );
+  }
+}
+
+DictionaryDatum
+mynest::ConditionWorkers::results() const
+{
+  std::vector< long >* condition = new std::vector< long >();
+  std::vector< long >* senders = new std::vector< long >();
+  std::vector< double >* times = new std::vector< double >();
+  for ( long k = 0; k < n_conditions_; ++k )
+  {
+    condition->insert( condition->end(), senders_[ k ].size(), k );
+    senders->insert(
+      senders->end(), senders_[ k ].begin(), senders_[ k ].end() );
+    times->insert( times->end(), times_[ k ].begin(), times_[ k ].end() );
+  }
+
+  DictionaryDatum d( new Dictionary );
+  ( *d )[ names::condition ] = IntVectorDatum( condition );
+  ( *d )[ nest::names::senders ] = IntVectorDatum( senders );
+  ( *d )[ nest::names::times ] = DoubleVectorDatum( times );
+  return d;
+}
+
+void
+mynest::ConditionWorkers::finish_worker( bool failed )
+{
+  if ( not worker_context.is_worker )
+  {
+    return;
+  }
+
+  int exit_code = failed ? 1 : 0;
+  if ( not failed )
+  {
+    try
+    {
+      const DictionaryDatum status =
+        nest::kernel().node_manager.get_status( worker_context.detector );
+      const DictionaryDatum events =
+        getValue< DictionaryDatum >( status, nest::names::events );
+      const std::vector< long > senders =
+        getValue< std::vector< long > >( ( *events )[ nest::names::senders ] );
+      const std::vector< double > times =
+        getValue< std::vector< double > >( ( *events )[ nest::names::times ] );
+
+      // spikes up to the fork were recorded by the parent already
+      std::vector< long > new_senders;
+      std::vector< double > new_times;
+      for ( size_t n = 0; n < senders.size() and n < times.size(); ++n )
+      {
+        if ( times[ n ] > worker_context.t_fork )
+        {
+          new_senders.push_back( senders[ n ] );
+          new_times.push_back( times[ n ] );
+        }
+      }
+
+      std::ofstream out( worker_context.result_file.c_str(),
+        std::ios::out | std::ios::binary | std::ios::trunc );
+      const unsigned long n_spikes = new_senders.size();
+      out.write( reinterpret_cast< const char* >( &n_spikes ),
+        sizeof( n_spikes ) );
+      if ( n_spikes > 0 )
+      {
+        out.write( reinterpret_cast< const char* >( &new_senders[ 0 ] ),
+          n_spikes * sizeof( long ) );
+        out.write( reinterpret_cast< const char* >( &new_times[ 0 ] ),
+          n_spikes * sizeof( double ) );
+      }
+      out.close();
+      exit_code = out.good() ? 0 : 1;
+    }
+    catch ( std::exception& e )
+    {
+      std::cerr << "Condition worker: " << e.what() << std::endl;
+      exit_code = 1;
+    }
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush( 0 );
+  // skip atexit handlers and destructors of the state shared with the parent
+  _exit( exit_code );
+}
+
+std::string
+mynest::ConditionWorkers::result_file_( long condition ) const
+{
+  std::ostringstream name;
+  name << prefix_ << condition << ".bin";
+  return name.str();
+}
+
+bool
+mynest::ConditionWorkers::read_result_( long condition )
+{
+  std::ifstream in( result_file_( condition ).c_str(),
+    std::ios::in | std::ios::binary );
+  unsigned long n_spikes = 0;
+  in.read( reinterpret_cast< char* >( &n_spikes ), sizeof( n_spikes ) );
+  if ( not in.good() )
+  {
+    return false;
+  }
+
+  senders_[ condition ].resize( n_spikes );
+  times_[ condition ].resize( n_spikes );
+  if ( n_spikes > 0 )
+  {
+    in.read( reinterpret_cast< char* >( &senders_[ condition ][ 0 ] ),
+      n_spikes * sizeof( long ) );
+    in.read( reinterpret_cast< char* >( &times_[ condition ][ 0 ] ),
+      n_spikes * sizeof( double ) );
+  }
+  return in.good();
+}
@@ -0,0 +1,147 @@
+/*
+ *  parallel_conditions.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PARALLEL_CONDITIONS_H
+#define PARALLEL_CONDITIONS_H
+
+// C++ includes:
+#include <map>
+#include <string>
+#include <vector>
+
+// C includes:
+#include <sys/types.h>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: parallel_conditions - Evaluate test conditions in forked workers.
+
+   Description:
+   After training, the test conditions of an experiment (stimulus
+   permutations, probe patterns, ...) are independent of each other: each
+   one starts from the trained network, applies its stimulus and simulates.
+   ForkConditions runs them in worker processes created with fork(), so
+   all workers share the trained network through copy-on-write pages and
+   only the memory they modify while simulating is copied.
+
+   ForkConditions returns twice, like fork(): in each worker it returns the
+   index of the condition to run; the worker sets up its condition,
+   simulates and calls FinishCondition, which hands the spikes recorded by
+   the spike detector after the fork to the parent and ends the worker.
+   In the parent, ForkConditions returns once all workers have finished,
+   with a dictionary holding the spikes of all conditions:
+     condition - condition index of each spike
+     senders   - GID of the sender of each spike
+     times     - spike time in ms
+
+   The spike detector must record to memory. Forking a multi-threaded or
+   MPI-parallel kernel is not supported. Output written by a worker to
+   files is not merged.
+
+   SeeAlso: ForkConditions, FinishCondition, ParallelConditions
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Exception thrown if the worker processes cannot be run.
+ */
+class ConditionWorkerError : public nest::KernelException
+{
+public:
+  ConditionWorkerError( const std::string& msg )
+    : KernelException( "ConditionWorkerError" )
+    , msg_( msg )
+  {
+  }
+
+  ~ConditionWorkerError() throw()
+  {
+  }
+
+  std::string message() const;
+
+private:
+  std::string msg_;
+};
+
+/**
+ * Forks one worker process per condition and collects their spikes.
+ */
+class ConditionWorkers
+{
+public:
+  /**
+   * @param detector GID of the spike detector read by the workers
+   * @param n_conditions number of conditions
+   * @param max_workers maximal number of concurrent workers, 0 for one
+   *                    worker per condition
+   */
+  ConditionWorkers( nest::index detector,
+    long n_conditions,
+    long max_workers );
+
+  /**
+   * Fork the workers and wait for them.
+   * Returns the condition index in a worker, and -1 in the parent after
+   * all workers have finished.
+   */
+  long run();
+
+  //! Spikes of all conditions, to be called in the parent after run()
+  DictionaryDatum results() const;
+
+  /**
+   * Hand the spikes recorded since the fork to the parent and terminate
+   * the worker process. Does nothing if called outside of a worker.
+   * @param failed true if the condition did not complete
+   */
+  static void finish_worker( bool failed );
+
+private:
+  std::string result_file_( long condition ) const;
+  //! Read the spikes of a finished worker, false if the file is unusable
+  bool read_result_( long condition );
+  //! Wait for the running workers and remove their result files, before
+  //! run() gives up
+  void reap_workers_( const std::map< pid_t, long >& running ) const;
+
+  nest::index detector_;
+  long n_conditions_;
+  long max_workers_;
+  double t_fork_;
+  std::string prefix_;
+  std::vector< std::vector< long > > senders_;
+  std::vector< std::vector< double > > times_;
+};
+
+} // namespace mynest
+
+#endif // PARALLEL_CONDITIONS_H
@@ -0,0 +1,283 @@
+/*
+ *  shm_recorder.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "shm_recorder.h"
+
+// C++ includes:
+#include <sstream>
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+#include "namedatum.h"
+#include "stringdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameters
+ * ---------------------------------------------------------------- */
+
+mynest::shm_recorder::Parameters_::Parameters_()
+  : shm_name_( "shm_recorder" )
+  , record_from_()
+  , interval_( nest::Time::ms( 1.0 ) )
+  , capacity_( 1 << 20 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::shm_recorder::Parameters_::get( DictionaryDatum& d ) const
+{
+  ( *d )[ names::shm_name ] = shm_name_;
+
+  ArrayDatum record_from;
+  for ( size_t j = 0; j < record_from_.size(); ++j )
+  {
+    record_from.push_back( LiteralDatum( record_from_[ j ] ) );
+  }
+  ( *d )[ nest::names::record_from ] = record_from;
+
+  def< double >( d, nest::names::interval, interval_.get_ms() );
+  def< long >( d, names::capacity, capacity_ );
+}
+
+void
+mynest::shm_recorder::Parameters_::set( const DictionaryDatum& d,
+  const bool connected )
+{
+  updateValue< std::string >( d, names::shm_name, shm_name_ );
+  if ( shm_name_.empty() or shm_name_.find( '/' ) != std::string::npos )
+  {
+    throw nest::BadProperty(
+      "shm_name must be non-empty and must not contain slashes." );
+  }
+
+  if ( d->known( nest::names::record_from ) )
+  {
+    if ( connected )
+    {
+      throw nest::BadProperty(
+        "record_from cannot be changed once neurons are connected." );
+    }
+    const ArrayDatum record_from =
+      getValue< ArrayDatum >( d, nest::names::record_from );
+    record_from_.clear();
+    for ( size_t j = 0; j < record_from.size(); ++j )
+    {
+      record_from_.push_back(
+        Name( getValue< std::string >( record_from[ j ] ) ) );
+    }
+  }
+
+  double interval;
+  if ( updateValue< double >( d, nest::names::interval, interval ) )
+  {
+    if ( connected )
+    {
+      throw nest::BadProperty(
+        "interval cannot be changed once neurons are connected." );
+    }
+    if ( interval < nest::Time::get_resolution().get_ms() )
+    {
+      throw nest::BadProperty(
+        "interval must be at least the simulation resolution." );
+    }
+    interval_ = nest::Time( nest::Time::ms( interval ) );
+    if ( not interval_.is_step() )
+    {
+      throw nest::BadProperty(
+        "interval must be a multiple of the simulation resolution." );
+    }
+  }
+
+  long capacity;
+  if ( updateValue< long >( d, names::capacity, capacity ) )
+  {
+    if ( connected )
+    {
+      throw nest::BadProperty(
+        "capacity cannot be changed once neurons are connected." );
+    }
+    if ( capacity < 1 )
+    {
+      throw nest::BadProperty( "capacity must be positive." );
+    }
+    capacity_ = capacity;
+  }
+}
+
+void
+mynest::shm_recorder::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+
+  long n_events = 0;
+  updateValue< long >( d, nest::names::n_events, n_events );
+  if ( ring_ )
+  {
+    n_events += ring_->n_written();
+  }
+  def< long >( d, nest::names::n_events, n_events );
+
+  // the instance on thread 0 also counts the records of the other threads
+  if ( get_thread() == 0 )
+  {
+    const nest::SiblingContainer* siblings =
+      nest::kernel().node_manager.get_thread_siblings( get_gid() );
+    std::vector< nest::Node* >::const_iterator sibling;
+    for ( sibling = siblings->begin() + 1; sibling != siblings->end();
+          ++sibling )
+    {
+      ( *sibling )->get_status( d );
+    }
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::shm_recorder::shm_recorder()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , ring_()
+  , connected_( false )
+{
+}
+
+mynest::shm_recorder::shm_recorder( const shm_recorder& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , ring_()
+  , connected_( false )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::shm_recorder::init_state_( const Node& proto )
+{
+  const shm_recorder& pr = downcast< shm_recorder >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::shm_recorder::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::shm_recorder::calibrate()
+{
+  device_.calibrate();
+
+  std::ostringstream name;
+  name << "/" << P_.shm_name_ << "-" << get_vp();
+  if ( ring_ and ring_->owned() and ring_->name() == name.str() )
+  {
+    return; // continue the ring of the previous simulation
+  }
+
+  // removes the ring of another name; a forked process only unmaps the
+  // ring of its parent and needs a ring of its own name
+  ring_.reset();
+  ring_.reset( new ShmRing( name.str(), P_.record_from_, P_.capacity_ ) );
+}
+
+/* ----------------------------------------------------------------
+ * Update and event handling functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::shm_recorder::update( nest::Time const& origin,
+  const long from,
+  const long )
+{
+  // as for the multimeter, the samples of the previous slice are requested
+  // at the beginning of each slice
+  if ( P_.record_from_.empty() or origin.get_steps() == 0 or from != 0 )
+  {
+    return;
+  }
+
+  nest::DataLoggingRequest req;
+  nest::kernel().event_delivery_manager.send( *this, req );
+}
+
+void
+mynest::shm_recorder::handle( nest::SpikeEvent& e )
+{
+  if ( not ring_ or not device_.is_active( e.get_stamp() ) )
+  {
+    return;
+  }
+
+  const double time = e.get_stamp().get_ms();
+  for ( int i = 0; i < e.get_multiplicity(); ++i )
+  {
+    ring_->push( time, e.get_sender_gid(), 0 );
+  }
+}
+
+void
+mynest::shm_recorder::handle( nest::DataLoggingReply& reply )
+{
+  if ( not ring_ )
+  {
+    return;
+  }
+
+  const nest::DataLoggingReply::Container& info = reply.get_info();
+  for ( size_t k = 0; k < info.size() and info[ k ].timestamp.is_finite();
+        ++k )
+  {
+    if ( device_.is_active( info[ k ].timestamp )
+      and info[ k ].data.size() == ring_->n_values() )
+    {
+      ring_->push( info[ k ].timestamp.get_ms(),
+        reply.get_sender_gid(),
+        info[ k ].data.data() );
+    }
+  }
+}
@@ -0,0 +1,248 @@
+/*
+ *  shm_recorder.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHM_RECORDER_H
+#define SHM_RECORDER_H
+
+// C++ includes:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Includes from nestkernel:
+#include "device.h"
+#include "device_node.h"
+#include "event.h"
+#include "exceptions.h"
+#include "nest_time.h"
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+#include "name.h"
+
+// Includes from LIFL_IE:
+#include "shm_ring.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: shm_recorder - Records to a ring buffer in shared memory.
+
+   Description:
+   The shm_recorder writes the spikes or the samples it records to a
+   shm_ring, from which another process reads them while the simulation
+   runs, without the conversion of the events to PyNEST dictionaries.
+   ShmRingReader in Examples/lifl_ie_io.py maps the ring with
+   numpy.frombuffer and returns the records written since its last read.
+
+   Without record_from, the recorder records the spikes of the neurons
+   connected to it, like a spike_detector; the records have no values.
+   With record_from, it samples the recordables of the neurons it is
+   connected to every interval, like a multimeter; each record holds the
+   values of one neuron at one time. Records are appended as they arrive,
+   so the records of one time slice are not sorted by time. As for these
+   devices, the records of the last time slice of a simulation are
+   written in the next simulation.
+
+   Each virtual process writes to its own ring, /<shm_name>-<vp>, which
+   is created at the first simulation and kept across simulations, so that
+   a reader can follow a loop of trials; it is removed when shm_name is
+   changed, on ResetKernel or at the end of NEST. Creating the ring fails if another running process has a
+   ring of this name, so concurrent simulations, e.g. the workers of
+   ForkConditions, need distinct shm_names. It holds the last capacity
+   records; a reader that falls behind by more records loses the oldest
+   ones. record_from, interval and capacity can not be changed once
+   neurons are connected.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   shm_name     string - Name of the rings, without slashes
+   record_from  array  - Names of the recordables, empty to record spikes
+   interval     double - Sampling interval in ms
+   capacity     int    - Number of records of each ring
+
+   The following parameter can be read out:
+
+   n_events     int    - Number of records written
+
+   Example:
+   SLI ] /shm_recorder Create /sr Set
+   SLI ] sr << /shm_name (v1_spikes) >> SetStatus
+   SLI ] neurons sr Connect
+   SLI ] 100000 Simulate
+
+   Receives: SpikeEvent, DataLoggingReply
+
+   SeeAlso: shm_ring, spike_detector, multimeter
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device writing spikes or samples to a shared memory ring.
+ */
+class shm_recorder : public nest::DeviceNode
+{
+
+public:
+  shm_recorder();
+  shm_recorder( const shm_recorder& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  //! Spikes are recorded on the thread of their sender
+  bool
+  local_receiver() const
+  {
+    return true;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  nest::port send_test_event( nest::Node&, nest::rport, nest::synindex, bool );
+
+  void handle( nest::SpikeEvent& );
+  void handle( nest::DataLoggingReply& );
+
+  nest::port handles_test_event( nest::SpikeEvent&, nest::rport );
+  nest::port handles_test_event( nest::DataLoggingReply&, nest::rport );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+
+  void update( nest::Time const&, const long, const long );
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    std::string shm_name_;
+    std::vector< Name > record_from_;
+    nest::Time interval_;
+    long capacity_;
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+
+    //! Set values from dictionary; connected if neurons are connected
+    void set( const DictionaryDatum&, bool connected );
+  };
+
+  // ------------------------------------------------------------
+
+  nest::Device device_;
+  Parameters_ P_;
+
+  std::unique_ptr< ShmRing > ring_; //!< Ring of this instance
+
+  //! True once neurons have been connected
+  bool connected_;
+};
+
+inline nest::port
+shm_recorder::send_test_event( nest::Node& target,
+  nest::rport receptor_type,
+  nest::synindex,
+  bool )
+{
+  if ( P_.record_from_.empty() )
+  {
+    throw nest::IllegalConnection(
+      "shm_recorder: set record_from to sample neurons." );
+  }
+  nest::DataLoggingRequest e( P_.interval_, P_.record_from_ );
+  e.set_sender( *this );
+  const nest::port p = target.handles_test_event( e, receptor_type );
+  if ( p != nest::invalid_port_ and not is_model_prototype() )
+  {
+    connected_ = true;
+  }
+  return p;
+}
+
+inline nest::port
+shm_recorder::handles_test_event( nest::SpikeEvent&,
+  nest::rport receptor_type )
+{
+  if ( receptor_type != 0 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  if ( not P_.record_from_.empty() )
+  {
+    throw nest::IllegalConnection(
+      "shm_recorder: spikes are only recorded without record_from." );
+  }
+  connected_ = true;
+  return 0;
+}
+
+inline nest::port
+shm_recorder::handles_test_event( nest::DataLoggingReply&,
+  nest::rport receptor_type )
+{
+  if ( receptor_type != 0 )
+  {
+    throw nest::UnknownReceptorType( receptor_type, get_name() );
+  }
+  return 0;
+}
+
+inline void
+shm_recorder::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_;     // temporary copy in case of errors
+  ptmp.set( d, connected_ ); // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+}
+
+} // namespace mynest
+
+#endif // SHM_RECORDER_H
@@ -0,0 +1,167 @@
+/*
+ *  shm_ring.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "shm_ring.h"
+
+// C++ includes:
+#include <cstring>
+#include <new>
+
+// C includes:
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const char shm_ring_magic[ 8 ] = { 'L', 'I', 'F', 'L', 'S', 'H', 'M', 'R' };
+const unsigned int shm_ring_version = 1;
+const size_t shm_ring_name_length = 32;
+const size_t shm_ring_alignment = 64; //!< records start on a cache line
+}
+
+std::string
+mynest::ShmRingError::message() const
+{
+  return msg_;
+}
+
+mynest::ShmRing::ShmRing( const std::string& name,
+  const std::vector< Name >& values,
+  const size_t capacity )
+  : name_( name )
+  , n_values_( values.size() )
+  , record_size_( ( 2 + values.size() ) * sizeof( double ) )
+  , capacity_( capacity )
+  , map_( MAP_FAILED )
+  , map_size_( 0 )
+  , header_( 0 )
+  , records_( 0 )
+  , owner_( getpid() )
+  , n_written_( 0 )
+{
+  static_assert( sizeof( Header ) == 64, "unexpected shm_ring header size" );
+
+  const size_t data_offset = ( ( sizeof( Header )
+                                 + n_values_ * shm_ring_name_length
+                                 + shm_ring_alignment - 1 )
+                               / shm_ring_alignment ) * shm_ring_alignment;
+  map_size_ = data_offset + capacity_ * record_size_;
+
+  int fd = shm_open( name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 );
+  if ( fd < 0 and errno == EEXIST and owner_dead_( name_ ) )
+  {
+    // a ring left behind by a process that was killed is replaced
+    shm_unlink( name_.c_str() );
+    fd = shm_open( name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 );
+  }
+  if ( fd < 0 and errno == EEXIST )
+  {
+    throw ShmRingError( "Shared memory " + name_
+      + " is in use by another process; choose another shm_name." );
+  }
+  if ( fd < 0 )
+  {
+    throw ShmRingError( "Cannot create shared memory " + name_ + "." );
+  }
+  if ( ftruncate( fd, map_size_ ) != 0 )
+  {
+    close( fd );
+    shm_unlink( name_.c_str() );
+    throw ShmRingError( "Cannot allocate shared memory " + name_ + "." );
+  }
+  map_ = mmap( 0, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd ); // the mapping keeps the object
+  if ( map_ == MAP_FAILED )
+  {
+    shm_unlink( name_.c_str() );
+    throw ShmRingError( "Cannot map shared memory " + name_ + "." );
+  }
+
+  // the object is zero-filled, so readers see no records until the
+  // header is complete
+  char* base = static_cast< char* >( map_ );
+  for ( size_t j = 0; j < n_values_; ++j )
+  {
+    std::strncpy( base + sizeof( Header ) + j * shm_ring_name_length,
+      values[ j ].toString().c_str(),
+      shm_ring_name_length );
+  }
+  header_ = new ( map_ ) Header();
+  header_->version = shm_ring_version;
+  header_->n_values = n_values_;
+  header_->record_size = record_size_;
+  header_->capacity = capacity_;
+  header_->data_offset = data_offset;
+  header_->n_written.store( 0, std::memory_order_relaxed );
+  header_->owner = owner_;
+  records_ = base + data_offset;
+
+  std::atomic_thread_fence( std::memory_order_release );
+  std::memcpy( header_->magic, shm_ring_magic, sizeof( header_->magic ) );
+}
+
+mynest::ShmRing::~ShmRing()
+{
+  munmap( map_, map_size_ );
+  if ( owned() )
+  {
+    shm_unlink( name_.c_str() );
+  }
+}
+
+bool
+mynest::ShmRing::owner_dead_( const std::string& name )
+{
+  const int fd = shm_open( name.c_str(), O_RDONLY, 0 );
+  if ( fd < 0 )
+  {
+    return false;
+  }
+  struct stat st;
+  void* map = MAP_FAILED;
+  if ( fstat( fd, &st ) == 0
+    and static_cast< size_t >( st.st_size ) >= sizeof( Header ) )
+  {
+    map = mmap( 0, sizeof( Header ), PROT_READ, MAP_SHARED, fd, 0 );
+  }
+  close( fd );
+  if ( map == MAP_FAILED )
+  {
+    return false;
+  }
+
+  // a ring whose header is incomplete may still be created right now
+  const Header* header = static_cast< const Header* >( map );
+  bool dead = false;
+  if ( std::memcmp( header->magic, shm_ring_magic, sizeof( header->magic ) )
+      == 0
+    and header->owner > 0 )
+  {
+    dead = kill( header->owner, 0 ) != 0 and errno == ESRCH;
+  }
+  munmap( map, sizeof( Header ) );
+  return dead;
+}
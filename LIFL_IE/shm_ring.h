@@ -0,0 +1,200 @@
+/*
+ *  shm_ring.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+// C++ includes:
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// C includes:
+#include <unistd.h>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+
+// Includes from sli:
+#include "name.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: shm_ring - Ring buffer of records in POSIX shared memory.
+
+   Description:
+   A shm_ring is a POSIX shared memory object, /dev/shm/<name> on Linux,
+   holding the latest records of a shm_recorder, so that another process,
+   e.g. Python with ShmRingReader of Examples/lifl_ie_io.py, can map it
+   with numpy.frombuffer and follow the simulation while it runs.
+
+   Layout (all values in native byte order):
+     header  : char[8] "LIFLSHMR", uint32 version, uint32 number of
+               values n, uint64 record size in bytes, uint64 capacity in
+               records, uint64 offset of the records, uint64 number of
+               records written, int32 pid of the writer, 12 bytes
+               reserved (64 bytes in all)
+     names   : char[32] name of each value (padded with NUL)
+     records : from the offset of the records, capacity records of
+               double time in ms, int64 GID, double[n] values
+   Record k of the stream is stored in slot k modulo capacity. The
+   writer fills the slot before it increases the number of records
+   written, so a reader that has read the number m may read records
+   max(0, m - capacity) to m - 1; a record it copies is valid if the
+   number written, read again after the copy, is less than its index plus
+   capacity.
+
+   Creating a ring fails if an object of the same name exists, unless
+   the process that created it no longer runs; such a ring, left behind
+   by a killed simulation, is replaced.
+
+   SeeAlso: shm_recorder
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Exception thrown if a shared memory ring cannot be created.
+ */
+class ShmRingError : public nest::KernelException
+{
+public:
+  ShmRingError( const std::string& msg )
+    : KernelException( "ShmRingError" )
+    , msg_( msg )
+  {
+  }
+
+  ~ShmRingError() throw()
+  {
+  }
+
+  std::string message() const;
+
+private:
+  std::string msg_;
+};
+
+/**
+ * Writer of a shared memory ring.
+ *
+ * The shared memory object is created by the constructor and removed by
+ * the destructor of the creating process; processes that have mapped it
+ * keep their mapping. A forked child inherits the mapping but must not
+ * write to it, see owned().
+ */
+class ShmRing
+{
+public:
+  /**
+   * Create the shared memory object name (with the leading slash) for
+   * capacity records of the named values.
+   */
+  ShmRing( const std::string& name,
+    const std::vector< Name >& values,
+    size_t capacity );
+  ~ShmRing();
+
+  const std::string&
+  name() const
+  {
+    return name_;
+  }
+
+  //! True in the process that created the ring
+  bool
+  owned() const
+  {
+    return owner_ == getpid();
+  }
+
+  size_t
+  n_values() const
+  {
+    return n_values_;
+  }
+
+  //! Number of records written
+  unsigned long
+  n_written() const
+  {
+    return n_written_;
+  }
+
+  /**
+   * Append a record; values points to n_values() values.
+   */
+  void
+  push( const double time, const long sender, const double* values )
+  {
+    char* slot = records_ + ( n_written_ % capacity_ ) * record_size_;
+    double* fields = reinterpret_cast< double* >( slot );
+    fields[ 0 ] = time;
+    *reinterpret_cast< long* >( fields + 1 ) = sender;
+    for ( size_t j = 0; j < n_values_; ++j )
+    {
+      fields[ 2 + j ] = values[ j ];
+    }
+    // publish the record after it is complete
+    header_->n_written.store( ++n_written_, std::memory_order_release );
+  }
+
+private:
+  ShmRing( const ShmRing& );            //!< not implemented
+  ShmRing& operator=( const ShmRing& ); //!< not implemented
+
+  /**
+   * Header of the shared memory object.
+   */
+  struct Header
+  {
+    char magic[ 8 ];
+    unsigned int version;
+    unsigned int n_values;
+    unsigned long record_size;
+    unsigned long capacity;
+    unsigned long data_offset;
+    std::atomic< unsigned long > n_written;
+    int owner;
+    char reserved_[ 12 ];
+  };
+
+  //! True if name is a ring whose writer provably no longer runs
+  static bool owner_dead_( const std::string& name );
+
+  std::string name_;
+  size_t n_values_;
+  size_t record_size_;
+  size_t capacity_;
+  void* map_;       //!< start of the mapping
+  size_t map_size_; //!< length of the mapping in bytes
+  Header* header_;
+  char* records_;
+  pid_t owner_; //!< process that created the ring
+  unsigned long n_written_; //!< copy of the header field, writer only
+};
+
+} // namespace mynest
+
+#endif // SHM_RING_H
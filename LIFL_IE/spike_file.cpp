@@ -0,0 +1,131 @@
+/*
+ *  spike_file.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spike_file.h"
+
+// C++ includes:
+#include <cstring>
+
+// C includes:
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const char spike_file_magic[ 8 ] = { 'L', 'I', 'F', 'L', 'S', 'P', 'K', 'F' };
+const unsigned int spike_file_version = 1;
+
+/**
+ * Header of a spike file, as stored on disk.
+ */
+struct SpikeFileHeader
+{
+  char magic[ 8 ];
+  unsigned int version;
+  unsigned int n_channels;
+  unsigned long n_spikes;
+};
+}
+
+std::string
+mynest::SpikeFileError::message() const
+{
+  return msg_;
+}
+
+mynest::MappedSpikeFile::MappedSpikeFile( const std::string& filename )
+  : filename_( filename )
+  , n_channels_( 0 )
+  , n_spikes_( 0 )
+  , map_( MAP_FAILED )
+  , map_size_( 0 )
+  , records_( 0 )
+{
+  const int fd = open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 )
+  {
+    throw SpikeFileError( "Cannot open spike file " + filename
+      + " for reading." );
+  }
+
+  struct stat st;
+  if ( fstat( fd, &st ) != 0
+    or static_cast< size_t >( st.st_size ) < sizeof( SpikeFileHeader ) )
+  {
+    close( fd );
+    throw SpikeFileError( filename + " is not a spike file." );
+  }
+  map_size_ = st.st_size;
+  map_ = mmap( 0, map_size_, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd ); // the mapping keeps the file open
+  if ( map_ == MAP_FAILED )
+  {
+    throw SpikeFileError( "Cannot map spike file " + filename + "." );
+  }
+
+  SpikeFileHeader header;
+  std::memcpy( &header, map_, sizeof( header ) );
+  if ( std::memcmp( header.magic, spike_file_magic, sizeof( header.magic ) )
+      != 0
+    or header.version != spike_file_version )
+  {
+    munmap( map_, map_size_ );
+    throw SpikeFileError( filename + " is not a spike file "
+                                     "of a supported version." );
+  }
+  if ( map_size_
+    != sizeof( header ) + header.n_spikes * sizeof( SpikeFileRecord ) )
+  {
+    munmap( map_, map_size_ );
+    throw SpikeFileError( "Spike file " + filename + " is truncated." );
+  }
+
+  n_channels_ = header.n_channels;
+  n_spikes_ = header.n_spikes;
+  records_ = reinterpret_cast< const SpikeFileRecord* >(
+    static_cast< const char* >( map_ ) + sizeof( header ) );
+
+  // spikes are read front to back: read ahead aggressively
+  madvise( map_, map_size_, MADV_SEQUENTIAL );
+}
+
+mynest::MappedSpikeFile::~MappedSpikeFile()
+{
+  munmap( map_, map_size_ );
+}
+
+void
+mynest::MappedSpikeFile::release( size_t end ) const
+{
+  const size_t page = sysconf( _SC_PAGESIZE );
+  const size_t offset =
+    sizeof( SpikeFileHeader ) + end * sizeof( SpikeFileRecord );
+  const size_t length = offset / page * page;
+  if ( length > 0 )
+  {
+    // pages of a read-only file mapping are simply dropped and would be
+    // read again on access
+    madvise( map_, length, MADV_DONTNEED );
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ *  spike_file.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SPIKE_FILE_H
+#define SPIKE_FILE_H
+
+// C++ includes:
+#include <cstddef>
+#include <string>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: spike_file - Binary spike-train file played by spike_file_player.
+
+   Description:
+   A spike file holds the spike trains of a number of input channels as one
+   stream of spikes sorted by time, so that a player can decode it
+   sequentially and only touches the part of the file belonging to the
+   current time window. Files are written by write_spike_file in
+   Examples/lifl_ie_io.py.
+
+   File layout (all values in native byte order):
+     header : char[8] "LIFLSPKF", uint32 version, uint32 number of
+              channels, uint64 number of spikes
+     spike  : double time in ms, uint32 channel, uint32 reserved (0);
+              spikes are sorted by time, spikes at the same time may
+              come in any channel order
+
+   SeeAlso: spike_file_player
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Exception thrown if a spike file cannot be opened or is malformed.
+ */
+class SpikeFileError : public nest::KernelException
+{
+public:
+  SpikeFileError( const std::string& msg )
+    : KernelException( "SpikeFileError" )
+    , msg_( msg )
+  {
+  }
+
+  ~SpikeFileError() throw()
+  {
+  }
+
+  std::string message() const;
+
+private:
+  std::string msg_;
+};
+
+/**
+ * One spike of a spike file, as stored on disk.
+ */
+struct SpikeFileRecord
+{
+  double time;            //!< spike time in ms
+  unsigned int channel;   //!< input channel
+  unsigned int reserved_; //!< padding, 0
+};
+
+/**
+ * Read-only memory mapping of a spike file.
+ *
+ * The records are accessed in place; pages are read by the kernel when
+ * they are first touched. release() returns the pages of records that
+ * have been played, so that the resident part of the file stays bounded
+ * by the read-ahead window however long the file is.
+ */
+class MappedSpikeFile
+{
+public:
+  explicit MappedSpikeFile( const std::string& filename );
+  ~MappedSpikeFile();
+
+  const std::string&
+  filename() const
+  {
+    return filename_;
+  }
+
+  size_t
+  n_channels() const
+  {
+    return n_channels_;
+  }
+
+  size_t
+  n_spikes() const
+  {
+    return n_spikes_;
+  }
+
+  const SpikeFileRecord&
+  operator[]( size_t i ) const
+  {
+    return records_[ i ];
+  }
+
+  /**
+   * Drop the mapped pages that only hold records before record end.
+   */
+  void release( size_t end ) const;
+
+private:
+  MappedSpikeFile( const MappedSpikeFile& );            //!< not implemented
+  MappedSpikeFile& operator=( const MappedSpikeFile& ); //!< not implemented
+
+  std::string filename_;
+  size_t n_channels_;
+  size_t n_spikes_;
+  void* map_;       //!< start of the mapping
+  size_t map_size_; //!< length of the mapping in bytes
+  const SpikeFileRecord* records_;
+};
+
+} // namespace mynest
+
+#endif // SPIKE_FILE_H
@@ -0,0 +1,289 @@
+/*
+ *  spike_file_player.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spike_file_player.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "integerdatum.h"
+#include "stringdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+namespace
+{
+//! Number of played spikes after which their pages are released
+const size_t release_interval = 65536;
+}
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameter
+ * ---------------------------------------------------------------- */
+
+mynest::spike_file_player::Parameters_::Parameters_()
+  : filename_()
+  , targets_()
+  , n_channels_( 0 )
+  , n_spikes_( 0 )
+{
+}
+
+mynest::spike_file_player::State_::State_()
+  : next_( 0 )
+  , n_played_( 0 )
+  , n_dropped_( 0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::spike_file_player::Parameters_::get( DictionaryDatum& d ) const
+{
+  def< std::string >( d, names::filename, filename_ );
+  ( *d )[ names::targets ] =
+    IntVectorDatum( new std::vector< long >( targets_ ) );
+  def< long >( d, names::n_channels, n_channels_ );
+  def< long >( d, names::n_spikes, n_spikes_ );
+}
+
+bool
+mynest::spike_file_player::Parameters_::set( const DictionaryDatum& d )
+{
+  updateValue< std::vector< long > >( d, names::targets, targets_ );
+  for ( size_t k = 0; k < targets_.size(); ++k )
+  {
+    if ( targets_[ k ] <= 0 )
+    {
+      throw nest::BadProperty( "targets must be GIDs of nodes." );
+    }
+  }
+
+  std::string filename;
+  if ( not updateValue< std::string >( d, names::filename, filename ) )
+  {
+    return false;
+  }
+
+  // check the file right away instead of failing in the simulation
+  n_channels_ = 0;
+  n_spikes_ = 0;
+  if ( not filename.empty() )
+  {
+    const MappedSpikeFile file( filename );
+    n_channels_ = file.n_channels();
+    n_spikes_ = file.n_spikes();
+  }
+  filename_ = filename;
+  return true;
+}
+
+void
+mynest::spike_file_player::State_::get( DictionaryDatum& d ) const
+{
+  def< long >( d, names::n_played, n_played_ );
+  def< long >( d, names::n_dropped, n_dropped_ );
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::spike_file_player::spike_file_player()
+  : DeviceNode()
+  , device_()
+  , P_()
+  , S_()
+{
+}
+
+mynest::spike_file_player::spike_file_player( const spike_file_player& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+  , S_( n.S_ )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::spike_file_player::init_state_( const Node& proto )
+{
+  const spike_file_player& pr = downcast< spike_file_player >( proto );
+
+  device_.init_state( pr.device_ );
+  S_ = pr.S_;
+}
+
+void
+mynest::spike_file_player::init_buffers_()
+{
+  device_.init_buffers();
+
+  B_.file_.reset();
+  B_.active_.clear();
+  B_.released_ = 0;
+}
+
+void
+mynest::spike_file_player::calibrate()
+{
+  device_.calibrate();
+
+  if ( P_.filename_.empty() )
+  {
+    B_.file_.reset();
+  }
+  else if ( not B_.file_ or B_.file_->filename() != P_.filename_ )
+  {
+    B_.file_ = std::make_shared< const MappedSpikeFile >( P_.filename_ );
+    B_.released_ = 0;
+  }
+
+  const size_t n_channels = B_.file_ ? B_.file_->n_channels() : 0;
+  B_.counts_.assign( n_channels, 0 );
+  B_.active_.clear();
+
+  V_.channel_of_.clear();
+  for ( size_t k = 0; k < P_.targets_.size() and k < n_channels; ++k )
+  {
+    V_.channel_of_[ P_.targets_[ k ] ] = k;
+  }
+}
+
+/* ----------------------------------------------------------------
+ * Update and event hook functions
+ * ---------------------------------------------------------------- */
+
+long
+mynest::spike_file_player::spike_step_( size_t i, long t0 ) const
+{
+  const MappedSpikeFile& file = *B_.file_;
+  if ( i > 0 and file[ i ].time < file[ i - 1 ].time )
+  {
+    throw SpikeFileError( "Spikes in " + file.filename()
+      + " are not sorted by time." );
+  }
+  return t0 + nest::Time( nest::Time::ms( file[ i ].time ) ).get_steps();
+}
+
+void
+mynest::spike_file_player::update( nest::Time const& origin,
+  const long from,
+  const long to )
+{
+  assert( to >= 0
+    && ( nest::delay ) from
+      < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  if ( not B_.file_ )
+  {
+    return;
+  }
+  const MappedSpikeFile& file = *B_.file_;
+
+  // a spike sent at lag offs arrives at step origin + offs + 1, so this
+  // slice covers the spikes arriving in (origin + from, origin + to]
+  const long t0 = device_.get_origin().get_steps();
+  const long first = origin.get_steps() + from + 1;
+  const long last = origin.get_steps() + to;
+
+  while ( S_.next_ < file.n_spikes() )
+  {
+    const long step = spike_step_( S_.next_, t0 );
+    if ( step > last )
+    {
+      break; // beyond this slice, decoded again in the next one
+    }
+    if ( step < first or not device_.is_active( nest::Time::step( step ) ) )
+    {
+      ++S_.n_dropped_;
+      ++S_.next_;
+      continue;
+    }
+
+    // gather the spikes of all channels arriving in this step
+    while (
+      S_.next_ < file.n_spikes() and spike_step_( S_.next_, t0 ) == step )
+    {
+      const unsigned int channel = file[ S_.next_ ].channel;
+      if ( channel >= B_.counts_.size() )
+      {
+        throw SpikeFileError( "Spike file " + file.filename()
+          + " contains a spike of an unknown channel." );
+      }
+      if ( B_.counts_[ channel ]++ == 0 )
+      {
+        B_.active_.push_back( channel );
+      }
+      ++S_.n_played_;
+      ++S_.next_;
+    }
+
+    nest::DSSpikeEvent se;
+    nest::kernel().event_delivery_manager.send(
+      *this, se, step - 1 - origin.get_steps() );
+
+    for ( size_t k = 0; k < B_.active_.size(); ++k )
+    {
+      B_.counts_[ B_.active_[ k ] ] = 0;
+    }
+    B_.active_.clear();
+  }
+
+  if ( S_.next_ >= B_.released_ + release_interval )
+  {
+    file.release( S_.next_ );
+    B_.released_ = S_.next_;
+  }
+}
+
+void
+mynest::spike_file_player::event_hook( nest::DSSpikeEvent& e )
+{
+  const std::unordered_map< nest::index, size_t >::const_iterator it =
+    V_.channel_of_.find( e.get_receiver().get_gid() );
+  if ( it == V_.channel_of_.end() )
+  {
+    return; // target without a channel in the file
+  }
+
+  const long n_spikes = B_.counts_[ it->second ];
+  if ( n_spikes > 0 )
+  {
+    e.set_multiplicity( n_spikes );
+    e.get_receiver().handle( e );
+  }
+}
@@ -0,0 +1,270 @@
+/*
+ *  spike_file_player.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SPIKE_FILE_PLAYER_H
+#define SPIKE_FILE_PLAYER_H
+
+// C++ includes:
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Includes from nestkernel:
+#include "connection.h"
+#include "device_node.h"
+#include "event.h"
+#include "nest_types.h"
+#include "stimulating_device.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+// Includes from LIFL_IE:
+#include "spike_file.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: spike_file_player - Plays the spike trains of a spike file.
+
+   Description:
+   The spike_file_player emits the spike trains of all channels of a spike
+   file, such as precomputed retina/LGN responses, to its targets. Channel
+   k is sent to the node targets[k]; the player is connected to these
+   nodes with any connection rule, typically all_to_all.
+
+   The file is memory-mapped and decoded as the simulation proceeds: in
+   each min-delay slice only the spikes falling into the slice are read,
+   and the pages of the spikes already played are released again. Long
+   stimulus libraries are therefore never loaded into memory as a whole,
+   and a single player serves thousands of channels.
+
+   Spike times in the file are relative to the origin of the player; a
+   spike at time t is delivered at origin + t. Spikes before the current
+   simulation time when they are reached, or outside of the (start, stop]
+   window of the player, are dropped and counted in n_dropped. The player
+   keeps its position in the file across Simulate calls; setting filename
+   (again) rewinds it.
+
+   As for other generators, each thread has its own instance of the player,
+   which maps the file and sends to the targets on its thread.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   filename    string    - Spike file to play, see spike_file
+   targets     int array - Target node of each channel
+   n_channels  int       - Number of channels in the file (read only)
+   n_spikes    int       - Number of spikes in the file (read only)
+   n_played    int       - Number of spikes emitted so far (read only)
+   n_dropped   int       - Number of spikes dropped so far (read only)
+
+   Example:
+   Feed the LGN parrot neurons of the V1 example from a converted
+   response file, starting at the current time:
+
+   player = nest.Create('spike_file_player', 1, {
+                'filename': 'files/spikes_reponse_gabor_randn02_19.spk',
+                'targets': list(LGN),
+                'origin': nest.GetKernelStatus('time')})
+   nest.Connect(player, LGN, 'all_to_all')
+
+   Sends: SpikeEvent
+
+   SeeAlso: spike_generator, spike_file
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Device playing the channels of a memory-mapped spike file.
+ */
+class spike_file_player : public nest::DeviceNode
+{
+
+public:
+  spike_file_player();
+  spike_file_player( const spike_file_player& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::event_hook;
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  nest::port send_test_event( nest::Node&, nest::rport, nest::synindex, bool );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+  //! Send the spikes of the target's channel in the current step
+  void event_hook( nest::DSSpikeEvent& );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+
+  void update( nest::Time const&, const long, const long );
+
+  //! Delivery step of spike i of the file, spike times are relative to t0
+  long spike_step_( size_t i, long t0 ) const;
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    std::string filename_;        //!< Spike file played
+    std::vector< long > targets_; //!< Target GID per channel
+    long n_channels_;             //!< Channels in the file
+    long n_spikes_;               //!< Spikes in the file
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+
+    //! Set values from dictionary, return true if a new file was given
+    bool set( const DictionaryDatum& );
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * State variables of the model.
+   */
+  struct State_
+  {
+    size_t next_;    //!< Index of the next spike to play
+    long n_played_;  //!< Spikes emitted
+    long n_dropped_; //!< Spikes dropped
+
+    State_(); //!< Default initialization
+
+    void get( DictionaryDatum& ) const;
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Buffers of the model.
+   */
+  struct Buffers_
+  {
+    std::shared_ptr< const MappedSpikeFile > file_; //!< Mapped spike file
+
+    //! Spikes per channel in the step being sent
+    std::vector< long > counts_;
+
+    //! Channels with spikes in the step being sent
+    std::vector< unsigned int > active_;
+
+    size_t released_; //!< Spikes whose pages have been released
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    //! Channel sent to each target GID
+    std::unordered_map< nest::index, size_t > channel_of_;
+  };
+
+  // ------------------------------------------------------------
+
+  nest::StimulatingDevice< nest::SpikeEvent > device_;
+  Parameters_ P_;
+  State_ S_;
+  Buffers_ B_;
+  Variables_ V_;
+};
+
+inline nest::port
+spike_file_player::send_test_event( nest::Node& target,
+  nest::rport receptor_type,
+  nest::synindex syn_id,
+  bool dummy_target )
+{
+  device_.enforce_single_syn_type( syn_id );
+
+  // as for poisson_generator, the events sent pass through event_hook,
+  // which sets the number of spikes for each target
+  if ( dummy_target )
+  {
+    nest::DSSpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+  else
+  {
+    nest::SpikeEvent e;
+    e.set_sender( *this );
+    return target.handles_test_event( e, receptor_type );
+  }
+}
+
+inline void
+spike_file_player::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  S_.get( d );
+  device_.get_status( d );
+}
+
+inline void
+spike_file_player::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_;               // temporary copy in case of errors
+  const bool new_file = ptmp.set( d ); // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+  if ( new_file )
+  {
+    S_ = State_(); // play the new file from its beginning
+    B_.file_.reset();
+  }
+}
+
+} // namespace mynest
+
+#endif // SPIKE_FILE_PLAYER_H
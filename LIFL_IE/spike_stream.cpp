@@ -0,0 +1,159 @@
+/*
+ *  spike_stream.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spike_stream.h"
+
+// C++ includes:
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+const char spike_stream_magic[ 8 ] = { 'L', 'I', 'F', 'L', 'S', 'P', 'K', 'S' };
+const char spike_stream_index_magic[ 8 ] = {
+  'L', 'I', 'F', 'L', 'S', 'I', 'D', 'X'
+};
+const unsigned int spike_stream_version = 1;
+
+/**
+ * Header of a spike stream, as stored on disk.
+ */
+struct SpikeStreamHeader
+{
+  char magic[ 8 ];
+  unsigned int version;
+  unsigned int reserved_;
+  double resolution;
+};
+
+/**
+ * Header of a block, as stored on disk.
+ */
+struct SpikeStreamBlockHeader
+{
+  long first_step;
+  long last_step;
+  unsigned int n_spikes;
+  unsigned int n_bytes;
+};
+}
+
+std::string
+mynest::SpikeStreamError::message() const
+{
+  return msg_;
+}
+
+mynest::SpikeStreamWriter::SpikeStreamWriter( const std::string& filename,
+  const double resolution )
+  : filename_( filename )
+  , file_( std::fopen( filename.c_str(), "wb" ) )
+  , offset_( sizeof( SpikeStreamHeader ) )
+  , n_spikes_( 0 )
+  , index_()
+  , bytes_()
+{
+  if ( file_ == 0 )
+  {
+    throw SpikeStreamError( "Cannot open spike stream " + filename
+      + " for writing." );
+  }
+
+  SpikeStreamHeader header;
+  std::memset( &header, 0, sizeof( header ) );
+  std::memcpy( header.magic, spike_stream_magic, sizeof( header.magic ) );
+  header.version = spike_stream_version;
+  header.resolution = resolution;
+  if ( std::fwrite( &header, sizeof( header ), 1, file_ ) != 1 )
+  {
+    std::fclose( file_ );
+    throw SpikeStreamError( "Cannot write spike stream " + filename + "." );
+  }
+}
+
+mynest::SpikeStreamWriter::~SpikeStreamWriter()
+{
+  // errors cannot be reported any more; a file without an index is
+  // still readable
+  const unsigned long n_blocks = index_.size();
+  if ( std::fwrite( index_.data(), sizeof( IndexEntry ), n_blocks, file_ )
+      == n_blocks
+    and std::fwrite( &n_blocks, sizeof( n_blocks ), 1, file_ ) == 1 )
+  {
+    std::fwrite( spike_stream_index_magic,
+      sizeof( spike_stream_index_magic ),
+      1,
+      file_ );
+  }
+  std::fclose( file_ );
+}
+
+void
+mynest::SpikeStreamWriter::write_block( const std::vector< Spike >& spikes,
+  const size_t begin,
+  const size_t end )
+{
+  if ( begin == end )
+  {
+    return;
+  }
+  assert( index_.empty() or spikes[ begin ].first >= index_.back().last_step );
+
+  bytes_.clear();
+  long previous = spikes[ begin ].first;
+  for ( size_t k = begin; k < end; ++k )
+  {
+    assert( spikes[ k ].first >= previous );
+    put_varint_( spikes[ k ].second );
+    put_varint_( spikes[ k ].first - previous );
+    previous = spikes[ k ].first;
+  }
+
+  SpikeStreamBlockHeader header;
+  std::memset( &header, 0, sizeof( header ) );
+  header.first_step = spikes[ begin ].first;
+  header.last_step = previous;
+  header.n_spikes = end - begin;
+  header.n_bytes = bytes_.size();
+  if ( std::fwrite( &header, sizeof( header ), 1, file_ ) != 1
+    or std::fwrite( bytes_.data(), 1, bytes_.size(), file_ )
+      != bytes_.size() )
+  {
+    throw SpikeStreamError( "Writing spike stream " + filename_
+      + " failed." );
+  }
+
+  const IndexEntry entry = { header.first_step, header.last_step, offset_ };
+  index_.push_back( entry );
+  offset_ += sizeof( header ) + bytes_.size();
+  n_spikes_ += end - begin;
+}
+
+void
+mynest::SpikeStreamWriter::flush()
+{
+  if ( std::fflush( file_ ) != 0 )
+  {
+    throw SpikeStreamError( "Writing spike stream " + filename_
+      + " failed." );
+  }
+}
@@ -0,0 +1,168 @@
+/*
+ *  spike_stream.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SPIKE_STREAM_H
+#define SPIKE_STREAM_H
+
+// C++ includes:
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: spike_stream - Compact binary file of recorded spikes.
+
+   Description:
+   A spike stream holds the spikes recorded by compact_spike_recorder on
+   one virtual process, sorted by time. The spikes are stored in blocks;
+   within a block each spike is a pair of unsigned LEB128 varints, the
+   GID of the sender and the number of steps since the previous spike of
+   the block (since the first step of the block for the first spike).
+   Most spikes thus take three to four bytes instead of the sixteen of a
+   time and sender pair. A block index at the end of the file lists the
+   time range and position of each block, so that the spikes of a time
+   window can be read without decoding the rest. read_spike_stream in
+   Examples/lifl_ie_io.py reads it.
+
+   File layout (all values in native byte order):
+     header  : char[8] "LIFLSPKS", uint32 version, uint32 reserved (0),
+               double simulation resolution in ms
+     block   : int64 first step, int64 last step, uint32 number of
+               spikes, uint32 number of bytes of the varints, varints
+     index   : int64 first step, int64 last step, uint64 file offset of
+               each block
+     trailer : uint64 number of blocks, char[8] "LIFLSIDX"
+   The time of a spike in ms is its step times the resolution. Blocks
+   follow each other in time and do not overlap. The index and trailer
+   are written when the file is closed; a file without them, e.g. of a
+   simulation that was killed, can still be read block by block.
+
+   SeeAlso: compact_spike_recorder, spike_file
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Exception thrown if a spike stream cannot be written.
+ */
+class SpikeStreamError : public nest::KernelException
+{
+public:
+  SpikeStreamError( const std::string& msg )
+    : KernelException( "SpikeStreamError" )
+    , msg_( msg )
+  {
+  }
+
+  ~SpikeStreamError() throw()
+  {
+  }
+
+  std::string message() const;
+
+private:
+  std::string msg_;
+};
+
+/**
+ * Writer of a spike stream.
+ *
+ * Spikes are handed over as (step, GID) pairs sorted by step, one block
+ * at a time. The index is written by the destructor.
+ */
+class SpikeStreamWriter
+{
+public:
+  typedef std::pair< long, unsigned long > Spike; //!< step and GID
+
+  SpikeStreamWriter( const std::string& filename, double resolution );
+
+  //! Write the block index and close the file
+  ~SpikeStreamWriter();
+
+  const std::string&
+  filename() const
+  {
+    return filename_;
+  }
+
+  //! Number of spikes written
+  unsigned long
+  n_spikes() const
+  {
+    return n_spikes_;
+  }
+
+  /**
+   * Encode spikes[begin, end) as one block; the steps must not decrease
+   * and must not be less than the last step of the previous block.
+   */
+  void write_block( const std::vector< Spike >& spikes,
+    size_t begin,
+    size_t end );
+
+  //! Pass the blocks written to the operating system
+  void flush();
+
+private:
+  SpikeStreamWriter( const SpikeStreamWriter& );            //!< not implemented
+  SpikeStreamWriter& operator=( const SpikeStreamWriter& ); //!< not implemented
+
+  //! Append value to bytes_ as unsigned LEB128
+  void
+  put_varint_( unsigned long value )
+  {
+    while ( value >= 0x80 )
+    {
+      bytes_.push_back( static_cast< unsigned char >( value | 0x80 ) );
+      value >>= 7;
+    }
+    bytes_.push_back( static_cast< unsigned char >( value ) );
+  }
+
+  /**
+   * Entry of the block index, as stored on disk.
+   */
+  struct IndexEntry
+  {
+    long first_step;
+    long last_step;
+    unsigned long offset;
+  };
+
+  std::string filename_;
+  std::FILE* file_;
+  unsigned long offset_; //!< file offset of the next block
+  unsigned long n_spikes_;
+  std::vector< IndexEntry > index_;
+  std::vector< unsigned char > bytes_; //!< varints of the current block
+};
+
+} // namespace mynest
+
+#endif // SPIKE_STREAM_H
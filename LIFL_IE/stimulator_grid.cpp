@@ -0,0 +1,240 @@
+/*
+ *  stimulator_grid.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stimulator_grid.h"
+
+// C++ includes:
+#include <algorithm>
+#include <exception>
+
+// Includes from nestkernel:
+#include "exceptions.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+#include "node.h"
+#include "numerics.h"
+
+// Includes from sli:
+#include "arraydatum.h"
+#include "dictutils.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+#include "lifl_psc_exp_ie.h"
+
+mynest::StimulatorGrid::StimulatorGrid( const std::vector< nest::index >& gids,
+  const DictionaryDatum& spec )
+  : gids_( gids )
+  , rows_( getValue< long >( spec, names::rows ) )
+  , columns_( getValue< long >( spec, names::columns ) )
+  , tile_rows_( 0 )
+  , tile_columns_( 0 )
+  , periodic_( false )
+  , stencil_()
+  , connect_( false )
+  , syn_id_( 0 )
+  , delay_( numerics::nan )
+  , weight_( numerics::nan )
+  , syn_params_( new Dictionary )
+{
+  if ( rows_ <= 0 or columns_ <= 0 )
+  {
+    throw nest::BadProperty( "rows and columns must be positive." );
+  }
+  if ( static_cast< size_t >( rows_ * columns_ ) != gids_.size() )
+  {
+    throw nest::BadProperty(
+      "The number of neurons must equal rows * columns." );
+  }
+
+  std::vector< long > tile;
+  if ( updateValue< std::vector< long > >( spec, names::tile, tile ) )
+  {
+    if ( tile.size() != 2 or tile[ 0 ] < 0 or tile[ 1 ] < 0 )
+    {
+      throw nest::BadProperty(
+        "tile must contain two non-negative numbers of rows and columns." );
+    }
+    tile_rows_ = tile[ 0 ];
+    tile_columns_ = tile[ 1 ];
+  }
+  updateValue< bool >( spec, names::periodic, periodic_ );
+
+  const TokenArray stencil = getValue< TokenArray >( spec, names::stencil );
+  for ( size_t k = 0; k < stencil.size(); ++k )
+  {
+    const std::vector< long > offset =
+      getValue< std::vector< long > >( stencil[ k ] );
+    if ( offset.size() != 2 )
+    {
+      throw nest::BadProperty(
+        "Each stencil entry must contain a row and a column offset." );
+    }
+    stencil_.push_back( offset[ 0 ] );
+    stencil_.push_back( offset[ 1 ] );
+  }
+
+  if ( spec->known( names::syn_spec ) )
+  {
+    const DictionaryDatum syn_spec =
+      getValue< DictionaryDatum >( spec, names::syn_spec );
+    const std::string model =
+      getValue< std::string >( syn_spec, nest::names::model );
+    const Token syn = nest::kernel().model_manager.get_synapsedict()->lookup(
+      model );
+    if ( syn.empty() )
+    {
+      throw nest::UnknownSynapseType( model );
+    }
+    syn_id_ = static_cast< nest::index >( getValue< long >( syn ) );
+    updateValue< double >( syn_spec, nest::names::delay, delay_ );
+    updateValue< double >( syn_spec, nest::names::weight, weight_ );
+    for ( Dictionary::const_iterator entry = syn_spec->begin();
+          entry != syn_spec->end();
+          ++entry )
+    {
+      if ( entry->first != nest::names::model
+        and entry->first != nest::names::delay
+        and entry->first != nest::names::weight )
+      {
+        syn_params_->insert( entry->first, entry->second );
+      }
+    }
+    connect_ = true;
+  }
+}
+
+std::vector< long >
+mynest::StimulatorGrid::modulators_( const size_t k ) const
+{
+  const long row = k / columns_;
+  const long column = k % columns_;
+
+  std::vector< long > result;
+  for ( size_t s = 0; s < stencil_.size(); s += 2 )
+  {
+    long r = row + stencil_[ s ];
+    long c = column + stencil_[ s + 1 ];
+    if ( periodic_ )
+    {
+      r = ( r % rows_ + rows_ ) % rows_;
+      c = ( c % columns_ + columns_ ) % columns_;
+    }
+    else if ( r < 0 or r >= rows_ or c < 0 or c >= columns_ )
+    {
+      continue;
+    }
+
+    if ( ( tile_rows_ > 0 and r / tile_rows_ != row / tile_rows_ )
+      or ( tile_columns_ > 0 and c / tile_columns_ != column / tile_columns_ ) )
+    {
+      continue; // outside the tile of the neuron
+    }
+
+    const long gid = gids_[ r * columns_ + c ];
+    if ( ( r == row and c == column )
+      or std::find( result.begin(), result.end(), gid ) != result.end() )
+    {
+      continue;
+    }
+    result.push_back( gid );
+  }
+  return result;
+}
+
+long
+mynest::StimulatorGrid::connect()
+{
+  const nest::thread n_threads = nest::kernel().vp_manager.get_num_threads();
+  std::vector< std::exception_ptr > errors( n_threads );
+  std::vector< long > n_set( n_threads, 0 );
+
+#pragma omp parallel
+  {
+    const nest::thread tid = nest::kernel().vp_manager.get_thread_id();
+    try
+    {
+      for ( size_t k = 0; k < gids_.size(); ++k )
+      {
+        const nest::index gid = gids_[ k ];
+        if ( not nest::kernel().node_manager.is_local_gid( gid ) )
+        {
+          continue;
+        }
+        nest::Node* node = nest::kernel().node_manager.get_node( gid, tid );
+        if ( node->get_thread() != tid )
+        {
+          continue; // handled by the thread owning the node
+        }
+
+        lifl_psc_exp_ie* detector = dynamic_cast< lifl_psc_exp_ie* >( node );
+        if ( detector == 0 )
+        {
+          throw nest::IllegalConnection( "ConnectStimulatorGrid: node "
+            + std::to_string( gid ) + " is not a lifl_psc_exp_ie neuron." );
+        }
+
+        const std::vector< long > modulators = modulators_( k );
+        detector->set_stimulators( modulators );
+        n_set[ tid ] += modulators.size();
+
+        if ( connect_ and syn_params_->empty() )
+        {
+          for ( size_t m = 0; m < modulators.size(); ++m )
+          {
+            nest::kernel().connection_manager.connect(
+              modulators[ m ], node, tid, syn_id_, delay_, weight_ );
+          }
+        }
+        else if ( connect_ )
+        {
+          // the connections read the dictionary, so each thread uses a copy
+          DictionaryDatum params( new Dictionary( *syn_params_ ) );
+          for ( size_t m = 0; m < modulators.size(); ++m )
+          {
+            nest::kernel().connection_manager.connect(
+              modulators[ m ], node, tid, syn_id_, params, delay_, weight_ );
+          }
+        }
+      }
+    }
+    catch ( ... )
+    {
+      errors[ tid ] = std::current_exception();
+    }
+  }
+
+  for ( nest::thread t = 0; t < n_threads; ++t )
+  {
+    if ( errors[ t ] )
+    {
+      std::rethrow_exception( errors[ t ] );
+    }
+  }
+
+  long total = 0;
+  for ( nest::thread t = 0; t < n_threads; ++t )
+  {
+    total += n_set[ t ];
+  }
+  return total;
+}
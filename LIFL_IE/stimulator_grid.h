@@ -0,0 +1,125 @@
+/*
+ *  stimulator_grid.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STIMULATOR_GRID_H
+#define STIMULATOR_GRID_H
+
+// C++ includes:
+#include <string>
+#include <vector>
+
+// Includes from nestkernel:
+#include "nest_types.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: stimulator_grid - IE modulator topology of a grid of detectors.
+
+   Description:
+   ConnectStimulatorGrid sets the stimulator (IE modulator) lists of a
+   population of lifl_psc_exp_ie neurons laid out on a 2D grid, and
+   optionally connects each modulator to the neuron it modulates. The
+   modulators of a neuron are its neighbours given by a stencil of row and
+   column offsets. The grid can be divided into tiles, in which case only
+   neighbours within the same tile are used, as in the 2x2 groups of
+   detectors of the V1 column example.
+
+   The population is given in row-major order. The modulator lists are set
+   and the connections made by the threads owning the neurons.
+
+   The specification dictionary contains:
+     rows      int         - Number of grid rows
+     columns   int         - Number of grid columns
+     stencil   array       - Offsets [row, column] of the modulators of a
+                             neuron, in the order of its stimulator list
+     tile      int array   - Rows and columns of a tile, optional; [0, 0]
+                             (default) for no tiling
+     periodic  bool        - Wrap around the grid borders, default false
+     syn_spec  dictionary  - If given, connect each modulator to the
+                             neuron with the synapse model (model) and the
+                             optional delay and weight given here; all
+                             other entries are set as parameters of each
+                             connection, e.g. tau_plus or Wmax
+
+   Example:
+   V1 column, 18 x 18 detectors in groups of 2 x 2:
+
+   nest.sli_func('ConnectStimulatorGrid', list(SS4), {
+       'rows': 18, 'columns': 18, 'tile': [2, 2],
+       'stencil': [[0, 1], [1, 0], [0, -1], [-1, 0]],
+       'syn_spec': {'model': 'stdp_synapse', 'delay': 0.1}})
+
+   SeeAlso: ConnectStimulatorGrid, lifl_psc_exp_ie
+
+   FirstVersion: 2020
+*/
+
+/**
+ * Grid of IE detectors and the stencil connecting their modulators.
+ */
+class StimulatorGrid
+{
+public:
+  /**
+   * Read and check the grid specification.
+   * @param gids  neurons in row-major order
+   * @param spec  specification dictionary, see documentation
+   * @throws BadProperty if the specification is inconsistent
+   */
+  StimulatorGrid( const std::vector< nest::index >& gids,
+    const DictionaryDatum& spec );
+
+  /**
+   * Set the modulators of all local neurons and make the connections.
+   * @returns number of modulator relations set on this process
+   * @throws UnknownNode or IllegalConnection if a node is not a
+   *         lifl_psc_exp_ie
+   */
+  long connect();
+
+private:
+  //! GIDs of the modulators of the neuron at the given grid index
+  std::vector< long > modulators_( size_t ) const;
+
+  std::vector< nest::index > gids_;
+  long rows_;
+  long columns_;
+  long tile_rows_;
+  long tile_columns_;
+  bool periodic_;
+  std::vector< long > stencil_; //!< row and column offsets, interleaved
+
+  bool connect_;
+  nest::index syn_id_;
+  double delay_;  //!< NaN for the synapse model's default
+  double weight_; //!< NaN for the synapse model's default
+  //! Further synapse parameters of syn_spec, empty if there are none
+  DictionaryDatum syn_params_;
+};
+
+} // namespace mynest
+
+#endif // STIMULATOR_GRID_H
@@ -0,0 +1,252 @@
+/*
+ *  trial_dc_generator.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "trial_dc_generator.h"
+
+// Includes from nestkernel:
+#include "event_delivery_manager_impl.h"
+#include "exceptions.h"
+#include "kernel_manager.h"
+
+// Includes from sli:
+#include "dict.h"
+#include "dictutils.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+
+// Includes from LIFL_IE:
+#include "lifl_ie_names.h"
+
+/* ----------------------------------------------------------------
+ * Default constructors defining default parameter
+ * ---------------------------------------------------------------- */
+
+mynest::trial_dc_generator::Parameters_::Parameters_()
+  : channel_( 0 )
+  , onsets_()
+  , durations_()
+  , amps_()
+  , perms_()
+  , trial_period_( 1000.0 ) // ms
+  , n_trials_( 0 )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Parameter extraction and manipulation functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::trial_dc_generator::Parameters_::get( DictionaryDatum& d ) const
+{
+  def< long >( d, names::channel, channel_ );
+  ( *d )[ names::onsets ] =
+    DoubleVectorDatum( new std::vector< double >( onsets_ ) );
+  ( *d )[ names::durations ] =
+    DoubleVectorDatum( new std::vector< double >( durations_ ) );
+  ( *d )[ names::amplitudes ] =
+    DoubleVectorDatum( new std::vector< double >( amps_ ) );
+  ( *d )[ names::permutations ] =
+    IntVectorDatum( new std::vector< long >( perms_ ) );
+  def< double >( d, names::trial_period, trial_period_ );
+  def< long >( d, names::n_trials, n_trials_ );
+}
+
+void
+mynest::trial_dc_generator::Parameters_::set( const DictionaryDatum& d )
+{
+  updateValue< long >( d, names::channel, channel_ );
+  updateValue< std::vector< double > >( d, names::onsets, onsets_ );
+  updateValue< std::vector< double > >( d, names::durations, durations_ );
+  updateValue< std::vector< double > >( d, names::amplitudes, amps_ );
+  updateValue< std::vector< long > >( d, names::permutations, perms_ );
+  updateValue< double >( d, names::trial_period, trial_period_ );
+  updateValue< long >( d, names::n_trials, n_trials_ );
+
+  const size_t n_slots = onsets_.size();
+  if ( durations_.size() != n_slots or amps_.size() != n_slots )
+  {
+    throw nest::BadProperty(
+      "onsets, durations and amplitudes must have the same size." );
+  }
+  if ( trial_period_ <= 0 )
+  {
+    throw nest::BadProperty( "trial_period must be positive." );
+  }
+  if ( n_trials_ < 0 )
+  {
+    throw nest::BadProperty( "n_trials must not be negative." );
+  }
+  for ( size_t s = 0; s < n_slots; ++s )
+  {
+    if ( onsets_[ s ] < 0 or durations_[ s ] < 0
+      or onsets_[ s ] + durations_[ s ] > trial_period_ )
+    {
+      throw nest::BadProperty( "All pulses must lie within the trial." );
+    }
+  }
+  if ( n_slots > 0
+    and ( channel_ < 0 or channel_ >= static_cast< long >( n_slots ) ) )
+  {
+    throw nest::BadProperty( "channel must be a valid slot index." );
+  }
+  if ( not perms_.empty() )
+  {
+    if ( n_slots == 0 or perms_.size() % n_slots != 0 )
+    {
+      throw nest::BadProperty(
+        "permutations must consist of rows with one entry per slot." );
+    }
+    for ( size_t i = 0; i < perms_.size(); ++i )
+    {
+      if ( perms_[ i ] < -1 or perms_[ i ] >= static_cast< long >( n_slots ) )
+      {
+        throw nest::BadProperty(
+          "permutations may only contain slot indices and -1." );
+      }
+    }
+  }
+}
+
+long
+mynest::trial_dc_generator::Parameters_::slot( long trial ) const
+{
+  if ( perms_.empty() )
+  {
+    return channel_;
+  }
+  const size_t n_slots = onsets_.size();
+  const size_t row = trial % ( perms_.size() / n_slots );
+  return perms_[ row * n_slots + channel_ ];
+}
+
+/* ----------------------------------------------------------------
+ * Default and copy constructor for node
+ * ---------------------------------------------------------------- */
+
+mynest::trial_dc_generator::trial_dc_generator()
+  : DeviceNode()
+  , device_()
+  , P_()
+{
+}
+
+mynest::trial_dc_generator::trial_dc_generator( const trial_dc_generator& n )
+  : DeviceNode( n )
+  , device_( n.device_ )
+  , P_( n.P_ )
+{
+}
+
+/* ----------------------------------------------------------------
+ * Node initialization functions
+ * ---------------------------------------------------------------- */
+
+void
+mynest::trial_dc_generator::init_state_( const Node& proto )
+{
+  const trial_dc_generator& pr = downcast< trial_dc_generator >( proto );
+
+  device_.init_state( pr.device_ );
+}
+
+void
+mynest::trial_dc_generator::init_buffers_()
+{
+  device_.init_buffers();
+}
+
+void
+mynest::trial_dc_generator::calibrate()
+{
+  device_.calibrate();
+
+  const size_t n_slots = P_.onsets_.size();
+  V_.onset_steps_.resize( n_slots );
+  V_.duration_steps_.resize( n_slots );
+  for ( size_t s = 0; s < n_slots; ++s )
+  {
+    V_.onset_steps_[ s ] =
+      nest::Time( nest::Time::ms( P_.onsets_[ s ] ) ).get_steps();
+    V_.duration_steps_[ s ] =
+      nest::Time( nest::Time::ms( P_.durations_[ s ] ) ).get_steps();
+  }
+  V_.trial_steps_ =
+    nest::Time( nest::Time::ms( P_.trial_period_ ) ).get_steps();
+  assert( V_.trial_steps_ > 0 );
+}
+
+/* ----------------------------------------------------------------
+ * Update function
+ * ---------------------------------------------------------------- */
+
+void
+mynest::trial_dc_generator::update( nest::Time const& origin,
+  const long from,
+  const long to )
+{
+  assert( to >= 0
+    && ( nest::delay ) from
+      < nest::kernel().connection_manager.get_min_delay() );
+  assert( from < to );
+
+  if ( P_.onsets_.empty() )
+  {
+    return;
+  }
+
+  // first step of trial 0
+  const long t0 =
+    device_.get_origin().get_steps() + device_.get_start().get_steps();
+
+  for ( long offs = from; offs < to; ++offs )
+  {
+    const long step = origin.get_steps() + offs;
+    if ( not device_.is_active( nest::Time::step( step ) ) )
+    {
+      continue;
+    }
+
+    // the current sent now acts on the target in the next step
+    const long rel = step + 1 - t0;
+    const long trial = rel / V_.trial_steps_;
+    if ( P_.n_trials_ > 0 and trial >= P_.n_trials_ )
+    {
+      continue;
+    }
+
+    const long s = P_.slot( trial );
+    if ( s < 0 )
+    {
+      continue; // channel silent in this trial
+    }
+
+    const long t_trial = rel % V_.trial_steps_;
+    if ( V_.onset_steps_[ s ] <= t_trial
+      and t_trial < V_.onset_steps_[ s ] + V_.duration_steps_[ s ] )
+    {
+      nest::CurrentEvent ce;
+      ce.set_current( P_.amps_[ s ] );
+      nest::kernel().event_delivery_manager.send( *this, ce, offs );
+    }
+  }
+}
@@ -0,0 +1,209 @@
+/*
+ *  trial_dc_generator.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRIAL_DC_GENERATOR_H
+#define TRIAL_DC_GENERATOR_H
+
+// C++ includes:
+#include <vector>
+
+// Includes from nestkernel:
+#include "connection.h"
+#include "device_node.h"
+#include "event.h"
+#include "nest_types.h"
+#include "stimulating_device.h"
+
+// Includes from sli:
+#include "dictdatum.h"
+
+namespace mynest
+{
+/* BeginDocumentation
+   Name: trial_dc_generator - DC pulses played from a trial schedule.
+
+   Description:
+   The trial_dc_generator plays one input line of a trial-based stimulation
+   protocol, such as the ordered input patterns of the MNSD example. The
+   schedule describes the pulses of all input lines (slots) within one
+   trial; each generator emits the pulse of the slot selected by its
+   channel, and repeats it every trial_period. A whole training or test
+   schedule is thus played by a single Simulate call, without changing
+   generator parameters between trials.
+
+   Trial k starts at origin + start + k * trial_period. Optionally, the
+   assignment of slots to channels changes from trial to trial: the rows of
+   permutations give, for each channel, the slot it plays, and trial k uses
+   row k modulo the number of rows. A slot index of -1 silences the channel
+   in that trial. Without permutations, channel c plays slot c.
+
+   The current of a pulse is stepwise constant, as for dc_generator, and
+   affects the target from onset to onset + duration within the trial.
+
+   Parameters:
+   The following parameters can be set in the status dictionary:
+
+   channel       int          - Input line played by this generator
+   onsets        double array - Pulse onsets within the trial in ms, one per
+                                slot
+   durations     double array - Pulse durations in ms, one per slot
+   amplitudes    double array - Pulse amplitudes in pA, one per slot
+   permutations  int array    - Slot played by each channel, one row of
+                                length n_slots per trial, rows flattened;
+                                empty for the identity
+   trial_period  double       - Trial length in ms
+   n_trials      int          - Number of trials to play, 0 for no limit
+
+   Example:
+   MNSD training, four ordered inputs, 300 trials of 1 s:
+
+   E = nest.Create('trial_dc_generator', 4, {
+           'onsets': [30.0, 33.3, 36.6, 40.0],
+           'durations': [25.0] * 4, 'amplitudes': [0.6575] * 4,
+           'trial_period': 1000.0, 'n_trials': 300})
+   nest.SetStatus(E, [{'channel': c} for c in range(4)])
+
+   Sends: CurrentEvent
+
+   SeeAlso: dc_generator, step_current_generator, lifl_psc_exp_ie
+
+   FirstVersion: 2020
+*/
+
+/**
+ * DC generator playing one channel of a periodic trial schedule.
+ */
+class trial_dc_generator : public nest::DeviceNode
+{
+
+public:
+  trial_dc_generator();
+  trial_dc_generator( const trial_dc_generator& );
+
+  bool
+  has_proxies() const
+  {
+    return false;
+  }
+
+  /**
+   * Import sets of overloaded virtual functions.
+   * @see Technical Issues / Virtual Functions: Overriding, Overloading, and
+   * Hiding
+   */
+  using nest::Node::handle;
+  using nest::Node::handles_test_event;
+
+  nest::port send_test_event( nest::Node&, nest::rport, nest::synindex, bool );
+
+  void get_status( DictionaryDatum& ) const;
+  void set_status( const DictionaryDatum& );
+
+private:
+  void init_state_( const Node& );
+  void init_buffers_();
+  void calibrate();
+
+  void update( nest::Time const&, const long, const long );
+
+  // ------------------------------------------------------------
+
+  /**
+   * Store independent parameters of the model.
+   */
+  struct Parameters_
+  {
+    long channel_;                    //!< Input line played
+    std::vector< double > onsets_;    //!< Pulse onsets in ms, per slot
+    std::vector< double > durations_; //!< Pulse durations in ms, per slot
+    std::vector< double > amps_;      //!< Pulse amplitudes in pA, per slot
+    std::vector< long > perms_;       //!< Slot per channel, per trial row
+    double trial_period_;             //!< Trial length in ms
+    long n_trials_;                   //!< Number of trials, 0 for no limit
+
+    Parameters_(); //!< Sets default parameter values
+
+    void get( DictionaryDatum& ) const; //!< Store current values in dictionary
+    void set( const DictionaryDatum& ); //!< Set values from dicitonary
+
+    //! Slot played by the channel in a trial, -1 if silent
+    long slot( long trial ) const;
+  };
+
+  // ------------------------------------------------------------
+
+  /**
+   * Internal variables of the model.
+   */
+  struct Variables_
+  {
+    std::vector< long > onset_steps_;    //!< Pulse onsets in steps
+    std::vector< long > duration_steps_; //!< Pulse durations in steps
+    long trial_steps_;                   //!< Trial length in steps
+  };
+
+  // ------------------------------------------------------------
+
+  nest::StimulatingDevice< nest::CurrentEvent > device_;
+  Parameters_ P_;
+  Variables_ V_;
+};
+
+inline nest::port
+trial_dc_generator::send_test_event( nest::Node& target,
+  nest::rport receptor_type,
+  nest::synindex syn_id,
+  bool )
+{
+  device_.enforce_single_syn_type( syn_id );
+
+  nest::CurrentEvent e;
+  e.set_sender( *this );
+
+  return target.handles_test_event( e, receptor_type );
+}
+
+inline void
+trial_dc_generator::get_status( DictionaryDatum& d ) const
+{
+  P_.get( d );
+  device_.get_status( d );
+}
+
+inline void
+trial_dc_generator::set_status( const DictionaryDatum& d )
+{
+  Parameters_ ptmp = P_; // temporary copy in case of errors
+  ptmp.set( d );         // throws if BadProperty
+
+  // We now know that ptmp is consistent. We do not write it back
+  // to P_ before we are also sure that the properties to be set
+  // in the parent class are internally consistent.
+  device_.set_status( d );
+
+  // if we get here, temporaries contain consistent set of properties
+  P_ = ptmp;
+}
+
+} // namespace mynest
+
+#endif // TRIAL_DC_GENERATOR_H